@@ -1,6 +1,6 @@
 """POC Selector 2.6.1 plugin — target_sticky + smt_fallback + early_select + greedy_search + lockless_bitmap + rr_improved toggles."""
 
-from PyQt5.QtWidgets import QCheckBox, QHBoxLayout
+from PyQt5.QtWidgets import QCheckBox, QComboBox, QHBoxLayout, QLabel
 import os
 
 SYSCTL_TARGET_STICKY    = "/proc/sys/kernel/sched_poc_target_sticky"
@@ -9,6 +9,17 @@ SYSCTL_RR_IMPROVED      = "/proc/sys/kernel/sched_poc_rr_improved"
 SYSCTL_EARLY_SELECT     = "/proc/sys/kernel/sched_poc_early_select"
 SYSCTL_GREEDY_SEARCH    = "/proc/sys/kernel/sched_poc_greedy_search"
 SYSCTL_LOCKLESS_BITMAP  = "/proc/sys/kernel/sched_poc_lockless_bitmap"
+SYSCTL_CROSS_LLC        = "/proc/sys/kernel/sched_poc_cross_llc"
+SYSCTL_IDLE_COALESCE    = "/proc/sys/kernel/sched_poc_idle_coalesce"
+SYSCTL_CLUSTER_SHARD    = "/proc/sys/kernel/sched_poc_cluster_shard"
+SYSCTL_ASYM             = "/proc/sys/kernel/sched_poc_asym"
+SYSCTL_CACHE_HOT        = "/proc/sys/kernel/sched_poc_cache_hot"
+SYSCTL_BATCH_POLICY     = "/proc/sys/kernel/sched_poc_batch_policy"
+SYSCTL_BURST            = "/proc/sys/kernel/sched_poc_burst"
+SYSCTL_SHALLOW_IDLE     = "/proc/sys/kernel/sched_poc_shallow_idle"
+SYSCTL_POLLING_IDLE     = "/proc/sys/kernel/sched_poc_polling_idle"
+SYSCTL_STACK_AVOID      = "/proc/sys/kernel/sched_poc_stack_avoid"
+SYSCTL_ISOLATED         = "/proc/sys/kernel/sched_poc_isolated"
 
 
 def _sysctl_read(path):
@@ -44,6 +55,24 @@ def _make_toggle(layout, label, tooltip, sysctl_path, writable):
     return chk
 
 
+def _make_choice(layout, label, tooltip, choices, sysctl_path, writable):
+    """Create a combo box bound to a sysctl taking values 0..len(choices)-1."""
+    layout.addWidget(QLabel(label))
+    box = QComboBox()
+    box.addItems(choices)
+    box.setToolTip(tooltip)
+    cur = _sysctl_read(sysctl_path)
+    if 0 <= cur < len(choices):
+        box.setCurrentIndex(cur)
+    if not writable:
+        box.setEnabled(False)
+        box.setToolTip("root required")
+    box.currentIndexChanged.connect(
+        lambda i: _sysctl_write(sysctl_path, i))
+    layout.addWidget(box)
+    return box
+
+
 def setup(layout):
     """Called by MainWindow to populate plugin controls row."""
     writable = os.access(SYSCTL_TARGET_STICKY, os.W_OK)
@@ -77,11 +106,12 @@ def setup(layout):
         SYSCTL_TARGET_STICKY, writable)
     row.addSpacing(15)
 
-    _make_toggle(row, "Greedy search",
-        "sched_poc_greedy_search: always attempt Level 5/6 LLC-wide "
-        "SMT sibling search regardless of utilization, ignoring the "
-        "SIS_UTIL overload gate (default: ON)",
-        SYSCTL_GREEDY_SEARCH, writable)
+    _make_choice(row, "Greedy search",
+        "sched_poc_greedy_search: Level 5/6 LLC-wide SMT sibling "
+        "search under the SIS_UTIL overload gate. off = skip it, "
+        "on = always search (default), adaptive = search while the "
+        "waker's recent wakeups saw at least 1/8 of the LLC idle",
+        ["off", "on", "adaptive"], SYSCTL_GREEDY_SEARCH, writable)
     row.addSpacing(15)
 
     _make_toggle(row, "Improved RR",
@@ -94,5 +124,99 @@ def setup(layout):
         SYSCTL_RR_IMPROVED, writable)
     row.addSpacing(15)
 
+    if os.path.exists(SYSCTL_CROSS_LLC):
+        _make_toggle(row, "Cross-LLC",
+            "sched_poc_cross_llc: when the target LLC has no idle CPU, "
+            "place the wakee on an idle core of a sibling LLC on the "
+            "same NUMA node (Level 7). Skipped for sync wakeups and "
+            "cache-hot wakees (default: OFF)",
+            SYSCTL_CROSS_LLC, writable)
+        row.addSpacing(15)
+
+    if os.path.exists(SYSCTL_IDLE_COALESCE):
+        _make_toggle(row, "Idle coalesce",
+            "sched_poc_idle_coalesce: leave the idle bit set on idle "
+            "exit and clear it at the next tick, so short busy periods "
+            "issue no LOCK'd bitmap writes. Atomic64 bitmap mode only "
+            "(default: OFF)",
+            SYSCTL_IDLE_COALESCE, writable)
+        row.addSpacing(15)
+
+    if os.path.exists(SYSCTL_CLUSTER_SHARD):
+        _make_toggle(row, "Cluster shard",
+            "sched_poc_cluster_shard: keep one idle word per L2 cluster "
+            "on its own cache line plus a cluster summary, so idle "
+            "transitions in different clusters never contend. Atomic64 "
+            "bitmap mode only (default: OFF)",
+            SYSCTL_CLUSTER_SHARD, writable)
+        row.addSpacing(15)
+
+    if os.path.exists(SYSCTL_ASYM):
+        _make_toggle(row, "Asym capacity",
+            "sched_poc_asym: on big.LITTLE / hybrid systems, maintain "
+            "the idle bitmaps and pick an idle CPU whose capacity fits "
+            "the task in O(capacity classes) instead of scanning with "
+            "select_idle_capacity() (default: OFF)",
+            SYSCTL_ASYM, writable)
+        row.addSpacing(15)
+
+    if os.path.exists(SYSCTL_CACHE_HOT):
+        _make_toggle(row, "Cache hot",
+            "sched_poc_cache_hot: before the cluster/LLC round-robin, "
+            "prefer an idle CPU whose last-ran mm matches the wakee's, "
+            "so pool threads land where their siblings left the working "
+            "set warm (default: OFF)",
+            SYSCTL_CACHE_HOT, writable)
+        row.addSpacing(15)
+
+    if os.path.exists(SYSCTL_BATCH_POLICY):
+        _make_choice(row, "Batch policy",
+            "sched_poc_batch_policy: search order for SCHED_BATCH / "
+            "SCHED_IDLE / cpu.idle wakees. core = strict idle-core "
+            "priority (default), smt = SMT-sibling-first like CFS, "
+            "sticky = return target if idle",
+            ["core", "smt", "sticky"], SYSCTL_BATCH_POLICY, writable)
+        row.addSpacing(15)
+
+    if os.path.exists(SYSCTL_BURST):
+        _make_toggle(row, "Burst",
+            "sched_poc_burst: when one task wakes several others back "
+            "to back, reserve CPUs for the rest of the burst from one "
+            "snapshot with one bitmap commit (Level B); unused "
+            "reservations return at the next tick (default: OFF)",
+            SYSCTL_BURST, writable)
+        row.addSpacing(15)
+
+    if os.path.exists(SYSCTL_SHALLOW_IDLE):
+        _make_toggle(row, "Shallow idle",
+            "sched_poc_shallow_idle: at Levels 2/3/5/6, prefer idle "
+            "CPUs whose cpuidle state exits in 20 us or less, falling "
+            "back to any idle CPU (default: OFF)",
+            SYSCTL_SHALLOW_IDLE, writable)
+        row.addSpacing(15)
+
+    if os.path.exists(SYSCTL_POLLING_IDLE):
+        _make_toggle(row, "Polling idle",
+            "sched_poc_polling_idle: at Levels 2/3/5/6, prefer idle "
+            "CPUs in a polling state, which wake without a reschedule "
+            "IPI (default: OFF)",
+            SYSCTL_POLLING_IDLE, writable)
+        row.addSpacing(15)
+
+    if os.path.exists(SYSCTL_STACK_AVOID):
+        _make_toggle(row, "Stack avoid",
+            "sched_poc_stack_avoid: when the LLC has no idle CPU and "
+            "the target already has a queue, wake on a CPU running a "
+            "single task instead (Level Q) (default: OFF)",
+            SYSCTL_STACK_AVOID, writable)
+        row.addSpacing(15)
+
+    if os.path.exists(SYSCTL_ISOLATED):
+        _make_toggle(row, "Isolated",
+            "sched_poc_isolated: never place wakeups on nohz_full / "
+            "isolcpus CPUs and skip their idle bitmap writes (default: OFF)",
+            SYSCTL_ISOLATED, writable)
+        row.addSpacing(15)
+
     row.addStretch()
     layout.addLayout(row)
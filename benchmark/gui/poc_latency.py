@@ -0,0 +1,1088 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0
+"""
+POC latency measurement core shared by poc_monitor.py and poc_sweep.py.
+
+GUI-free: histogram buckets, libc helpers, the LatencyEngine load
+generator (native C pthreads, with a Python fallback), cpuidle and POC
+sysctl helpers, and CPU info.
+"""
+
+import os
+import re
+import time
+import ctypes
+import threading
+import tempfile
+import subprocess
+
+# ---------------------------------------------------------------------------
+# Constants
+# ---------------------------------------------------------------------------
+
+HIST_BOUNDS_NS = [
+    1000, 2000, 4000, 8000, 16_000, 32_000,
+    64_000, 128_000, 256_000, 512_000, 1_024_000, float("inf"),
+]
+HIST_LABELS = [
+    "0\u20131\u00b5s", "1\u20132\u00b5s", "2\u20134\u00b5s", "4\u20138\u00b5s",
+    "8\u201316\u00b5s", "16\u201332\u00b5s", "32\u201364\u00b5s", "64\u2013128\u00b5s",
+    "128\u2013256\u00b5s", "256\u2013512\u00b5s", "0.5\u20131ms", ">1ms",
+]
+NUM_BUCKETS = 12
+
+# Fine log-linear bins for percentiles: 2^FINE_SUB_BITS per power of two
+# (~6% resolution) up to 2^31 ns
+FINE_SUB_BITS = 4
+NUM_FINE_BINS = (31 - FINE_SUB_BITS + 1) << FINE_SUB_BITS
+
+SYSCTL_POC_PATH = "/proc/sys/kernel/sched_poc_selector"
+
+# ---------------------------------------------------------------------------
+# libc helpers
+# ---------------------------------------------------------------------------
+
+PR_SET_TIMERSLACK = 29
+MAX_CSTATES = 8
+
+try:
+    _libc = ctypes.CDLL("libc.so.6", use_errno=True)
+    _libc.sched_getcpu.restype = ctypes.c_int
+    _libc.prctl.restype = ctypes.c_int
+    _libc.prctl.argtypes = [ctypes.c_int, ctypes.c_ulong,
+                            ctypes.c_ulong, ctypes.c_ulong, ctypes.c_ulong]
+    def _sched_getcpu():
+        return _libc.sched_getcpu()
+    def _prctl_set_timerslack(ns):
+        return _libc.prctl(PR_SET_TIMERSLACK, ns, 0, 0, 0)
+except Exception:
+    def _sched_getcpu():
+        return -1
+    def _prctl_set_timerslack(ns):
+        return -1
+
+# ---------------------------------------------------------------------------
+# Native load generator
+# ---------------------------------------------------------------------------
+#
+# The whole sleep -> wake -> measure loop runs in C pthreads, so the
+# sub-microsecond buckets see the scheduler and not CPython.  Each thread
+# owns its counters and is their only writer; readers take relaxed loads
+# and never stop a thread.  The engine mutex only serializes the control
+# path (resize / snapshot) against itself.
+#
+# Besides timer sleeps (which never set WF_SYNC) the engine runs
+# task-to-task wakeups, one group of threads per unit of load:
+#
+#   pipe    1:1 ping-pong over a pipe pair (sync wakeups)
+#   chain   futex token ring of N stages, producer -> consumer
+#   fanout  one master waking N workers at once, thread-pool style
+#
+# Latencies are kept twice: exactly in the HIST_BOUNDS_NS buckets, and in
+# log-linear "fine" bins (FINE_SUB_BITS bins per power of two) from which
+# percentiles are read.
+
+_NATIVE_SRC = r"""
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+
+#define SUB_BITS	@SUB_BITS@
+#define NR_FINE		@NR_FINE@
+#define NR_BUCKETS	@NR_BUCKETS@
+#define MAX_GROUPS	4096
+#define MAX_GROUP_SIZE	64
+
+#define LOAD(x)		__atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define LOAD_ACQ(x)	__atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define STORE(x, v)	__atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+/* Single writer: a plain add, published with a relaxed store */
+#define BUMP(x, v)	STORE(x, (x) + (v))
+
+enum { LAT_TIMER, LAT_PIPE, LAT_CHAIN, LAT_FANOUT };
+
+struct lat_counts {
+	uint64_t samples;
+	uint64_t sum_ns;
+	uint64_t migrations;
+	uint64_t hist[NR_BUCKETS];
+	uint64_t fine[NR_FINE];
+};
+
+struct lat_engine;
+struct lat_group;
+
+struct lat_thread {
+	struct lat_counts c;
+	struct lat_group *g;
+	pthread_t tid;
+	int idx;
+	int rd, wr;		/* pipe: read / write end */
+	uint32_t seq;		/* chain: futex word, bumped by the waker */
+	int64_t stamp;		/* chain: waker's clock at the wake */
+} __attribute__((aligned(64)));
+
+/*
+ * One unit of load: a single timer thread, a pipe pair, a futex ring of
+ * n stages, or a fan-out master with n - 1 workers.  Thread 0 drives
+ * the unit and is the only one that watches ->stop.
+ */
+struct lat_group {
+	struct lat_engine *e;
+	int n;
+	int stop;
+	int quit;		/* thread 0 -> the others: exit after waking */
+	uint32_t gen;		/* fan-out: broadcast futex word */
+	int64_t gen_stamp;
+	uint32_t done;		/* fan-out: workers done this round */
+	uint32_t mseq;		/* fan-out: futex word the master waits on */
+	int64_t mstamp;
+	struct lat_thread t[];
+};
+
+struct lat_engine {
+	int64_t sleep_ns;
+	int spin;
+	long slack_ns;
+	int mode;
+	int group_size;
+	int64_t bounds[NR_BUCKETS - 1];
+	pthread_mutex_t lock;	/* control path only; workers never take it */
+	int nr;
+	struct lat_group *g[MAX_GROUPS];
+	struct lat_counts retired;	/* folded in from joined groups */
+};
+
+static inline int64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static inline void futex_wait(uint32_t *uaddr, uint32_t val)
+{
+	syscall(SYS_futex, uaddr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static inline void futex_wake(uint32_t *uaddr, int nr)
+{
+	syscall(SYS_futex, uaddr, FUTEX_WAKE_PRIVATE, nr, NULL, NULL, 0);
+}
+
+/* Wait until *uaddr moves off @seen; returns the new value */
+static inline uint32_t futex_wait_change(uint32_t *uaddr, uint32_t seen)
+{
+	uint32_t v;
+
+	while ((v = LOAD_ACQ(*uaddr)) == seen)
+		futex_wait(uaddr, seen);
+	return v;
+}
+
+static inline int fine_bin(uint64_t v)
+{
+	int e;
+
+	if (v >= (1ULL << 31))
+		v = (1ULL << 31) - 1;
+	if (v < (1U << SUB_BITS))
+		return (int)v;
+	e = 63 - __builtin_clzll(v);
+	return ((e - SUB_BITS + 1) << SUB_BITS) |
+	       (int)((v >> (e - SUB_BITS)) & ((1U << SUB_BITS) - 1));
+}
+
+static void lat_record(struct lat_thread *t, int64_t lat, int cpu0)
+{
+	struct lat_counts *c = &t->c;
+	int cpu1 = sched_getcpu();
+	int b;
+
+	if (lat < 0)
+		lat = 0;
+	for (b = 0; b < NR_BUCKETS - 1; b++)
+		if (lat <= t->g->e->bounds[b])
+			break;
+
+	BUMP(c->hist[b], 1);
+	BUMP(c->fine[fine_bin(lat)], 1);
+	BUMP(c->sum_ns, (uint64_t)lat);
+	if (cpu0 >= 0 && cpu0 != cpu1)
+		BUMP(c->migrations, 1);
+	BUMP(c->samples, 1);
+}
+
+static void lat_slack(struct lat_engine *e, long *cur)
+{
+	long slack = LOAD(e->slack_ns);
+
+	if (slack != *cur) {
+		/* 0 resets to the default slack; 1 is the minimum */
+		prctl(PR_SET_TIMERSLACK, slack, 0, 0, 0);
+		*cur = slack;
+	}
+}
+
+/* Sleep (or spin) @sleep_ns past now; returns the deadline */
+static int64_t lat_sleep(struct lat_engine *e)
+{
+	int64_t deadline = now_ns() + LOAD(e->sleep_ns);
+	struct timespec ts = {
+		.tv_sec  = deadline / 1000000000LL,
+		.tv_nsec = deadline % 1000000000LL,
+	};
+
+	if (LOAD(e->spin)) {
+		while (now_ns() < deadline)
+			;
+	} else {
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+				       &ts, NULL) == EINTR)
+			;
+	}
+	return deadline;
+}
+
+/* Timer: latency from the sleep deadline to running again */
+static void lat_timer(struct lat_thread *t)
+{
+	struct lat_engine *e = t->g->e;
+	long slack = -1;
+
+	while (!LOAD(t->g->stop)) {
+		int cpu0;
+		int64_t deadline;
+
+		lat_slack(e, &slack);
+		cpu0 = sched_getcpu();
+		deadline = lat_sleep(e);
+		lat_record(t, now_ns() - deadline, cpu0);
+	}
+}
+
+/*
+ * Pipe ping-pong: thread 0 sends its clock, thread 1 records the wakeup
+ * and answers with its own clock.  pipe_write() wakes with WF_SYNC.
+ * Thread 0 thinks for sleep_ns between rounds when it is non-zero.
+ */
+static void lat_pipe(struct lat_thread *t)
+{
+	struct lat_group *g = t->g;
+	long slack = -1;
+	int64_t stamp;
+	int cpu0;
+
+	for (;;) {
+		if (t->idx == 0) {
+			if (LOAD(g->stop))
+				break;
+			lat_slack(g->e, &slack);
+			if (LOAD(g->e->sleep_ns))
+				lat_sleep(g->e);
+			stamp = now_ns();
+			if (write(t->wr, &stamp, sizeof(stamp)) != sizeof(stamp))
+				break;
+		}
+		cpu0 = sched_getcpu();
+		if (read(t->rd, &stamp, sizeof(stamp)) != sizeof(stamp))
+			break;
+		lat_record(t, now_ns() - stamp, cpu0);
+		if (t->idx != 0) {
+			stamp = now_ns();
+			if (write(t->wr, &stamp, sizeof(stamp)) != sizeof(stamp))
+				break;
+		}
+	}
+	/* EOF tells the peer to exit */
+	close(t->wr);
+	t->wr = -1;
+}
+
+static void lat_pass(struct lat_thread *to)
+{
+	STORE(to->stamp, now_ns());
+	__atomic_fetch_add(&to->seq, 1, __ATOMIC_RELEASE);
+	futex_wake(&to->seq, 1);
+}
+
+/*
+ * Futex chain: a token goes round a ring of stages; each stage wakes the
+ * next one with FUTEX_WAKE (no WF_SYNC).  Thread 0 thinks for sleep_ns
+ * before each lap when it is non-zero.
+ */
+static void lat_chain(struct lat_thread *t)
+{
+	struct lat_group *g = t->g;
+	struct lat_thread *next = &g->t[(t->idx + 1) % g->n];
+	uint32_t seen = 0;
+	long slack = -1;
+	int cpu0;
+
+	for (;;) {
+		if (t->idx == 0) {
+			if (LOAD(g->stop)) {
+				STORE(g->quit, 1);
+				lat_pass(next);
+				break;
+			}
+			lat_slack(g->e, &slack);
+			if (LOAD(g->e->sleep_ns))
+				lat_sleep(g->e);
+			lat_pass(next);
+		}
+		cpu0 = sched_getcpu();
+		seen = futex_wait_change(&t->seq, seen);
+		if (LOAD(g->quit)) {
+			if (t->idx != 0)
+				lat_pass(next);
+			break;
+		}
+		lat_record(t, now_ns() - LOAD(t->stamp), cpu0);
+		if (t->idx != 0)
+			lat_pass(next);
+	}
+}
+
+/*
+ * Fan-out: the master wakes all n - 1 workers at once through one
+ * futex word, thread-pool style; the last worker to finish wakes the
+ * master.  The master thinks for sleep_ns between bursts when non-zero.
+ */
+static void lat_fanout(struct lat_thread *t)
+{
+	struct lat_group *g = t->g;
+	uint32_t seen = 0;
+	long slack = -1;
+	int cpu0;
+
+	if (t->idx == 0) {
+		while (!LOAD(g->stop)) {
+			lat_slack(g->e, &slack);
+			if (LOAD(g->e->sleep_ns))
+				lat_sleep(g->e);
+			STORE(g->done, 0);
+			STORE(g->gen_stamp, now_ns());
+			__atomic_fetch_add(&g->gen, 1, __ATOMIC_RELEASE);
+			futex_wake(&g->gen, INT_MAX);
+
+			cpu0 = sched_getcpu();
+			seen = futex_wait_change(&g->mseq, seen);
+			lat_record(t, now_ns() - LOAD(g->mstamp), cpu0);
+		}
+		STORE(g->quit, 1);
+		__atomic_fetch_add(&g->gen, 1, __ATOMIC_RELEASE);
+		futex_wake(&g->gen, INT_MAX);
+		return;
+	}
+
+	for (;;) {
+		cpu0 = sched_getcpu();
+		seen = futex_wait_change(&g->gen, seen);
+		if (LOAD(g->quit))
+			break;
+		lat_record(t, now_ns() - LOAD(g->gen_stamp), cpu0);
+		if (__atomic_add_fetch(&g->done, 1, __ATOMIC_ACQ_REL) ==
+		    (uint32_t)g->n - 1) {
+			STORE(g->mstamp, now_ns());
+			__atomic_fetch_add(&g->mseq, 1, __ATOMIC_RELEASE);
+			futex_wake(&g->mseq, 1);
+		}
+	}
+}
+
+static void *lat_thread_fn(void *arg)
+{
+	struct lat_thread *t = arg;
+
+	switch (t->g->e->mode) {
+	case LAT_PIPE:
+		lat_pipe(t);
+		break;
+	case LAT_CHAIN:
+		lat_chain(t);
+		break;
+	case LAT_FANOUT:
+		lat_fanout(t);
+		break;
+	default:
+		lat_timer(t);
+		break;
+	}
+	return NULL;
+}
+
+static void lat_fold(struct lat_counts *dst, const struct lat_counts *src)
+{
+	int i;
+
+	dst->samples += LOAD(src->samples);
+	dst->sum_ns += LOAD(src->sum_ns);
+	dst->migrations += LOAD(src->migrations);
+	for (i = 0; i < NR_BUCKETS; i++)
+		dst->hist[i] += LOAD(src->hist[i]);
+	for (i = 0; i < NR_FINE; i++)
+		dst->fine[i] += LOAD(src->fine[i]);
+}
+
+/*
+ * Unblock threads 1..@started of a group whose thread 0 never ran:
+ * every wait re-checks ->quit, and an EOF ends a pipe reader.
+ */
+static void lat_group_abort(struct lat_group *g)
+{
+	int i;
+
+	STORE(g->quit, 1);
+	for (i = 0; i < g->n; i++) {
+		__atomic_fetch_add(&g->t[i].seq, 1, __ATOMIC_RELEASE);
+		futex_wake(&g->t[i].seq, 1);
+	}
+	__atomic_fetch_add(&g->gen, 1, __ATOMIC_RELEASE);
+	futex_wake(&g->gen, INT_MAX);
+	if (g->t[0].wr >= 0) {
+		close(g->t[0].wr);
+		g->t[0].wr = -1;
+	}
+}
+
+static void lat_group_free(struct lat_group *g)
+{
+	int i;
+
+	for (i = 0; i < g->n; i++) {
+		if (g->t[i].rd >= 0)
+			close(g->t[i].rd);
+		if (g->t[i].wr >= 0)
+			close(g->t[i].wr);
+	}
+	free(g);
+}
+
+static void lat_group_join(struct lat_engine *e, struct lat_group *g,
+			   int started)
+{
+	int i;
+
+	for (i = 0; i < started; i++) {
+		pthread_join(g->t[i].tid, NULL);
+		lat_fold(&e->retired, &g->t[i].c);
+	}
+}
+
+/* Start one group; thread 0 goes last so nothing drives a partial group */
+static struct lat_group *lat_group_start(struct lat_engine *e, const int *cpus,
+					 int *err)
+{
+	size_t size = sizeof(struct lat_group) +
+		      e->group_size * sizeof(struct lat_thread);
+	struct lat_group *g;
+	int i;
+
+	if (posix_memalign((void **)&g, 64, size)) {
+		*err = -ENOMEM;
+		return NULL;
+	}
+	memset(g, 0, size);
+	g->e = e;
+	g->n = e->group_size;
+	for (i = 0; i < g->n; i++) {
+		g->t[i].g = g;
+		g->t[i].idx = i;
+		g->t[i].rd = g->t[i].wr = -1;
+	}
+	if (e->mode == LAT_PIPE) {
+		int ab[2], ba[2];
+
+		if (pipe(ab)) {
+			*err = -errno;
+			free(g);
+			return NULL;
+		}
+		if (pipe(ba)) {
+			*err = -errno;
+			close(ab[0]);
+			close(ab[1]);
+			free(g);
+			return NULL;
+		}
+		g->t[0].wr = ab[1];
+		g->t[1].rd = ab[0];
+		g->t[1].wr = ba[1];
+		g->t[0].rd = ba[0];
+	}
+
+	for (i = g->n - 1; i >= 0; i--) {
+		pthread_attr_t attr;
+		int ret;
+
+		pthread_attr_init(&attr);
+		if (cpus && cpus[i] >= 0) {
+			cpu_set_t set;
+
+			CPU_ZERO(&set);
+			CPU_SET(cpus[i], &set);
+			pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+		}
+		ret = pthread_create(&g->t[i].tid, &attr, lat_thread_fn,
+				     &g->t[i]);
+		pthread_attr_destroy(&attr);
+		if (ret) {
+			/* threads i+1..n-1 are running and blocked */
+			lat_group_abort(g);
+			for (i++; i < g->n; i++) {
+				pthread_join(g->t[i].tid, NULL);
+				lat_fold(&e->retired, &g->t[i].c);
+			}
+			lat_group_free(g);
+			*err = -ret;
+			return NULL;
+		}
+	}
+	return g;
+}
+
+/*
+ * lat_create - @mode is LAT_*; @group_size is the number of threads per
+ * unit of load (1 for timer, 2 for pipe, >= 2 for chain and fan-out).
+ */
+struct lat_engine *lat_create(const int64_t *bounds, int mode, int group_size)
+{
+	struct lat_engine *e;
+
+	if (group_size < 1 || group_size > MAX_GROUP_SIZE)
+		return NULL;
+	e = calloc(1, sizeof(*e));
+	if (!e)
+		return NULL;
+	memcpy(e->bounds, bounds, sizeof(e->bounds));
+	e->mode = mode;
+	e->group_size = group_size;
+	pthread_mutex_init(&e->lock, NULL);
+	return e;
+}
+
+void lat_set(struct lat_engine *e, int64_t sleep_ns, int spin, long slack_ns)
+{
+	STORE(e->sleep_ns, sleep_ns);
+	STORE(e->spin, spin);
+	STORE(e->slack_ns, slack_ns);
+}
+
+/*
+ * lat_resize - start or stop groups until @nr are running.  @cpus, when
+ * non-NULL, gives the CPU thread j of new group i is pinned to
+ * (cpus[i * group_size + j]).  Returns the number of running groups, or
+ * -errno if a start failed.
+ */
+int lat_resize(struct lat_engine *e, int nr, const int *cpus)
+{
+	int ret = 0;
+
+	if (nr < 0)
+		nr = 0;
+	if (nr > MAX_GROUPS)
+		nr = MAX_GROUPS;
+
+	pthread_mutex_lock(&e->lock);
+	while (e->nr > nr) {
+		struct lat_group *g = e->g[--e->nr];
+
+		STORE(g->stop, 1);
+		lat_group_join(e, g, g->n);
+		lat_group_free(g);
+	}
+	while (e->nr < nr) {
+		struct lat_group *g;
+
+		g = lat_group_start(e, cpus ? cpus + e->nr * e->group_size
+					    : NULL, &ret);
+		if (!g)
+			break;
+		e->g[e->nr++] = g;
+	}
+	if (!ret)
+		ret = e->nr;
+	pthread_mutex_unlock(&e->lock);
+	return ret;
+}
+
+/* Cumulative counts of every thread ever run, in struct lat_counts order */
+void lat_snapshot(struct lat_engine *e, uint64_t *out)
+{
+	struct lat_counts *sum = (struct lat_counts *)out;
+	int i, j;
+
+	pthread_mutex_lock(&e->lock);
+	*sum = e->retired;
+	for (i = 0; i < e->nr; i++)
+		for (j = 0; j < e->g[i]->n; j++)
+			lat_fold(sum, &e->g[i]->t[j].c);
+	pthread_mutex_unlock(&e->lock);
+}
+
+void lat_destroy(struct lat_engine *e)
+{
+	lat_resize(e, 0, NULL);
+	pthread_mutex_destroy(&e->lock);
+	free(e);
+}
+"""
+
+# samples, sum_ns, migrations, hist[NUM_BUCKETS], fine[NUM_FINE_BINS]
+_SNAP_LEN = 3 + NUM_BUCKETS + NUM_FINE_BINS
+
+def _build_native_lib():
+    """Compile the native load generator; returns the ctypes library."""
+    src = (_NATIVE_SRC.replace("@SUB_BITS@", str(FINE_SUB_BITS))
+                      .replace("@NR_FINE@", str(NUM_FINE_BINS))
+                      .replace("@NR_BUCKETS@", str(NUM_BUCKETS)))
+    d = tempfile.mkdtemp(prefix="poc_lat_")
+    src_path = os.path.join(d, "lat.c")
+    lib_path = os.path.join(d, "lat.so")
+    with open(src_path, "w") as f:
+        f.write(src)
+    subprocess.run(
+        ["gcc", "-O2", "-shared", "-fPIC", "-pthread", "-o", lib_path, src_path],
+        check=True, capture_output=True,
+    )
+    lib = ctypes.CDLL(lib_path)
+    lib.lat_create.restype = ctypes.c_void_p
+    lib.lat_create.argtypes = [ctypes.POINTER(ctypes.c_int64),
+                               ctypes.c_int, ctypes.c_int]
+    lib.lat_set.restype = None
+    lib.lat_set.argtypes = [ctypes.c_void_p, ctypes.c_int64,
+                            ctypes.c_int, ctypes.c_long]
+    lib.lat_resize.restype = ctypes.c_int
+    lib.lat_resize.argtypes = [ctypes.c_void_p, ctypes.c_int,
+                               ctypes.POINTER(ctypes.c_int)]
+    lib.lat_snapshot.restype = None
+    lib.lat_snapshot.argtypes = [ctypes.c_void_p,
+                                 ctypes.POINTER(ctypes.c_uint64)]
+    lib.lat_destroy.restype = None
+    lib.lat_destroy.argtypes = [ctypes.c_void_p]
+    return lib
+
+_native = None
+try:
+    _native = _build_native_lib()
+except Exception:
+    pass  # fall back to Python workers
+
+# ---------------------------------------------------------------------------
+# cpuidle C-state helpers
+# ---------------------------------------------------------------------------
+
+def _sysfs_read(path):
+    try:
+        with open(path) as f:
+            return f.read().strip()
+    except Exception:
+        return None
+
+def _sysfs_write(path, val):
+    try:
+        with open(path, "w") as f:
+            f.write(str(val))
+        return True
+    except Exception:
+        return False
+
+def cstate_detect():
+    """Return list of (name, latency_us) for each C-state on cpu0."""
+    states = []
+    for s in range(MAX_CSTATES):
+        name = _sysfs_read(
+            f"/sys/devices/system/cpu/cpu0/cpuidle/state{s}/name")
+        if name is None:
+            break
+        lat = _sysfs_read(
+            f"/sys/devices/system/cpu/cpu0/cpuidle/state{s}/latency")
+        states.append((name, int(lat) if lat else 0))
+    return states
+
+def cstate_save_disable(nr_cstates):
+    """Save current disable flags from cpu0."""
+    orig = []
+    for s in range(nr_cstates):
+        v = _sysfs_read(
+            f"/sys/devices/system/cpu/cpu0/cpuidle/state{s}/disable")
+        orig.append(int(v) if v is not None else -1)
+    return orig
+
+def cstate_apply(max_cstate, nr_cstates, nr_cpus):
+    """Disable C-states deeper than max_cstate on all CPUs. -1 = no limit."""
+    for cpu in range(nr_cpus):
+        for s in range(nr_cstates):
+            path = (f"/sys/devices/system/cpu/cpu{cpu}"
+                    f"/cpuidle/state{s}/disable")
+            _sysfs_write(path, 1 if (max_cstate >= 0 and s > max_cstate) else 0)
+
+def cstate_restore(orig, nr_cpus):
+    """Restore original disable flags on all CPUs."""
+    for cpu in range(nr_cpus):
+        for s, v in enumerate(orig):
+            if v < 0:
+                continue
+            path = (f"/sys/devices/system/cpu/cpu{cpu}"
+                    f"/cpuidle/state{s}/disable")
+            _sysfs_write(path, v)
+
+# ---------------------------------------------------------------------------
+# POC sysctl helpers
+# ---------------------------------------------------------------------------
+
+def poc_get():
+    try:
+        with open(SYSCTL_POC_PATH) as f:
+            return int(f.read().strip())
+    except Exception:
+        return -1
+
+def poc_set(val):
+    try:
+        with open(SYSCTL_POC_PATH, "w") as f:
+            f.write(str(val))
+        return True
+    except Exception:
+        return False
+
+def poc_active():
+    try:
+        with open("/sys/kernel/poc_selector/status/active") as f:
+            return int(f.read().strip())
+    except Exception:
+        return -1
+
+def poc_writable():
+    return os.access(SYSCTL_POC_PATH, os.W_OK)
+
+# ---------------------------------------------------------------------------
+# CPU info helpers
+# ---------------------------------------------------------------------------
+
+def _cpu_info():
+    """Gather CPU model, topology, and ISA feature info."""
+    info = {
+        "model": "unknown",
+        "cores": 0,
+        "threads": os.cpu_count() or 0,
+        "l2": "",
+        "l3": "",
+        "flags": [],
+    }
+    # Parse /proc/cpuinfo
+    try:
+        with open("/proc/cpuinfo") as f:
+            cpuinfo = f.read()
+        phys_ids = set()
+        core_ids = set()
+        for line in cpuinfo.splitlines():
+            if line.startswith("model name") and info["model"] == "unknown":
+                info["model"] = line.split(":", 1)[1].strip()
+            elif line.startswith("physical id"):
+                phys_ids.add(line.split(":", 1)[1].strip())
+            elif line.startswith("core id"):
+                core_ids.add(line.split(":", 1)[1].strip())
+        if core_ids:
+            info["cores"] = len(core_ids) * max(1, len(phys_ids))
+    except Exception:
+        pass
+    # L2/L3 cache from sysfs
+    for idx in range(10):
+        level = _sysfs_read(f"/sys/devices/system/cpu/cpu0/cache/index{idx}/level")
+        size = _sysfs_read(f"/sys/devices/system/cpu/cpu0/cache/index{idx}/size")
+        shared = _sysfs_read(
+            f"/sys/devices/system/cpu/cpu0/cache/index{idx}/shared_cpu_list")
+        if level is None:
+            break
+        desc = size or "?"
+        if shared:
+            ncpus = 0
+            for part in shared.split(","):
+                if "-" in part:
+                    lo, hi = part.split("-", 1)
+                    ncpus += int(hi) - int(lo) + 1
+                else:
+                    ncpus += 1
+            if ncpus > 1:
+                desc += f" (shared/{ncpus})"
+        if level == "2":
+            info["l2"] = desc
+        elif level == "3":
+            info["l3"] = desc
+    # HW acceleration from POC sysfs
+    hw_dir = "/sys/kernel/poc_selector/hw_accel"
+    try:
+        for name in sorted(os.listdir(hw_dir)):
+            val = _sysfs_read(os.path.join(hw_dir, name))
+            if val:
+                m = re.match(r"HW\s*\((.+)\)", val)
+                if m:
+                    info["flags"].append(m.group(1))
+    except Exception:
+        pass
+    return info
+
+def _cpu_info_text():
+    """Format CPU info as a single display string."""
+    ci = _cpu_info()
+    parts = [ci["model"]]
+    parts.append(f"{ci['cores']}C/{ci['threads']}T")
+    if ci["l2"]:
+        parts.append(f"L2: {ci['l2']}")
+    if ci["l3"]:
+        parts.append(f"L3: {ci['l3']}")
+    if ci["flags"]:
+        parts.append("HW: " + " ".join(ci["flags"]))
+    return "  \u00b7  ".join(parts)
+
+# ---------------------------------------------------------------------------
+# Latency counters and workers
+# ---------------------------------------------------------------------------
+
+def fine_bin(v):
+    """Fine histogram bin of a latency in ns (mirrors fine_bin() in C)."""
+    v = min(int(v), (1 << 31) - 1)
+    if v < (1 << FINE_SUB_BITS):
+        return v
+    e = v.bit_length() - 1
+    return (((e - FINE_SUB_BITS + 1) << FINE_SUB_BITS)
+            | ((v >> (e - FINE_SUB_BITS)) & ((1 << FINE_SUB_BITS) - 1)))
+
+def fine_value(b):
+    """Representative latency in ns of fine bin @b (its midpoint)."""
+    if b < (1 << FINE_SUB_BITS):
+        return b
+    e = (b >> FINE_SUB_BITS) + FINE_SUB_BITS - 1
+    m = b & ((1 << FINE_SUB_BITS) - 1)
+    low = ((1 << FINE_SUB_BITS) | m) << (e - FINE_SUB_BITS)
+    return low + ((1 << (e - FINE_SUB_BITS)) - 1) / 2
+
+
+class LatencyStats:
+    """Cumulative latency counters; subtract two snapshots for an interval."""
+
+    __slots__ = ("samples", "sum_ns", "migrations", "hist", "fine")
+
+    def __init__(self, samples=0, sum_ns=0, migrations=0, hist=None, fine=None):
+        self.samples = samples
+        self.sum_ns = sum_ns
+        self.migrations = migrations
+        self.hist = hist if hist is not None else [0] * NUM_BUCKETS
+        self.fine = fine if fine is not None else [0] * NUM_FINE_BINS
+
+    def _combine(self, o, sign):
+        return LatencyStats(
+            self.samples + sign * o.samples,
+            self.sum_ns + sign * o.sum_ns,
+            self.migrations + sign * o.migrations,
+            [a + sign * b for a, b in zip(self.hist, o.hist)],
+            [a + sign * b for a, b in zip(self.fine, o.fine)])
+
+    def __add__(self, o):
+        return self._combine(o, 1)
+
+    def __sub__(self, o):
+        return self._combine(o, -1)
+
+    def mean_ns(self):
+        return self.sum_ns / self.samples if self.samples else 0.0
+
+    def percentile_ns(self, q):
+        """Latency at quantile @q, to fine-bin resolution."""
+        if not self.samples:
+            return 0.0
+        rank = min(int(self.samples * q), self.samples - 1)
+        acc = 0
+        for b, cnt in enumerate(self.fine):
+            acc += cnt
+            if acc > rank:
+                return fine_value(b)
+        return fine_value(NUM_FINE_BINS - 1)
+
+    def max_ns(self):
+        for b in range(NUM_FINE_BINS - 1, -1, -1):
+            if self.fine[b]:
+                return fine_value(b)
+        return 0.0
+
+
+class _PyWorker(threading.Thread):
+    """Pure-Python worker, used only when the native helper can't be built."""
+
+    def __init__(self, engine, cpu):
+        super().__init__(daemon=True)
+        self._engine = engine
+        self._cpu = cpu
+        self._halt = threading.Event()
+        self.stats = LatencyStats()
+
+    def run(self):
+        eng = self._engine
+        st = self.stats
+        getcpu = _sched_getcpu
+        gettime = time.clock_gettime_ns
+        CLK = time.CLOCK_MONOTONIC
+        bounds = HIST_BOUNDS_NS
+
+        if self._cpu >= 0:
+            os.sched_setaffinity(0, {self._cpu})
+        cur_slack = -1
+        while not self._halt.is_set():
+            if eng._slack != cur_slack:
+                _prctl_set_timerslack(eng._slack)
+                cur_slack = eng._slack
+
+            cpu0 = getcpu()
+            deadline = gettime(CLK) + eng._sleep_ns
+            if eng._spin:
+                while gettime(CLK) < deadline:
+                    pass
+            else:
+                time.sleep(max(0, deadline - gettime(CLK)) / 1e9)
+            t1 = gettime(CLK)
+            cpu1 = getcpu()
+
+            lat = max(0, t1 - deadline)
+            b = 0
+            while lat > bounds[b]:
+                b += 1
+            st.hist[b] += 1
+            st.fine[fine_bin(lat)] += 1
+            st.sum_ns += lat
+            if cpu0 >= 0 and cpu0 != cpu1:
+                st.migrations += 1
+            st.samples += 1
+
+    def halt(self):
+        self._halt.set()
+
+
+# name -> (LAT_* mode, threads per group as a function of the group arg)
+WORKLOADS = {
+    "timer":  (0, lambda n: 1),
+    "pipe":   (1, lambda n: 2),
+    "chain":  (2, lambda n: max(2, n)),
+    "fanout": (3, lambda n: 1 + max(1, n)),
+}
+
+
+class LatencyEngine:
+    """Pool of workers doing rapid wakeups to stress select_idle_sibling().
+
+    With @workload "timer" each worker sleeps until an absolute
+    CLOCK_MONOTONIC deadline (or spins to it) and records how late it
+    woke.  The other WORKLOADS run task-to-task wakeups in groups of
+    threads and record the time from the wake call to the wakee running;
+    @group_arg is the chain length or fan-out width, and resize() counts
+    groups.  For those, a non-zero sleep is think time for the thread
+    that starts each round.
+
+    snapshot() returns the cumulative LatencyStats of every thread the
+    engine has run; callers diff two snapshots for an interval.  Threads
+    float by default; with @pin, thread i is bound to the i-th allowed
+    CPU, which bypasses idle-CPU selection and so gives a no-selection
+    baseline.
+    """
+
+    native = _native is not None
+
+    def __init__(self, sleep_ns, spin=False, timer_slack=0, pin=False,
+                 workload="timer", group_arg=4):
+        if workload not in WORKLOADS:
+            raise ValueError("unknown workload %r" % workload)
+        mode, size = WORKLOADS[workload]
+        if mode and not self.native:
+            raise RuntimeError("workload %r needs the native helper (gcc)"
+                               % workload)
+        self.workload = workload
+        self.group_size = size(group_arg)
+        self._sleep_ns = int(sleep_ns)
+        self._spin = bool(spin)
+        self._slack = int(timer_slack)
+        self._pin = pin
+        self._cpus = sorted(os.sched_getaffinity(0))
+        self._workers = []      # Python fallback only
+        self._retired = LatencyStats()
+        self._nr = 0
+        self._eng = None
+        if self.native:
+            bounds = (ctypes.c_int64 * (NUM_BUCKETS - 1))(
+                *[int(b) for b in HIST_BOUNDS_NS[:-1]])
+            self._eng = _native.lat_create(bounds, mode, self.group_size)
+            if not self._eng:
+                raise ValueError("lat_create(%s, %d)"
+                                 % (workload, self.group_size))
+            self._push()
+
+    def _push(self):
+        if self._eng:
+            _native.lat_set(self._eng, self._sleep_ns, int(self._spin),
+                            self._slack)
+
+    def set_params(self, sleep_ns=None, spin=None, timer_slack=None):
+        """Change parameters live; running workers pick them up next cycle."""
+        if sleep_ns is not None:
+            self._sleep_ns = int(sleep_ns)
+        if spin is not None:
+            self._spin = bool(spin)
+        if timer_slack is not None:
+            self._slack = int(timer_slack)
+        self._push()
+
+    def __len__(self):
+        return self._nr
+
+    def resize(self, nr):
+        """Start or stop workers (groups of threads) until @nr are running."""
+        nr = max(0, nr)
+        nt = nr * self.group_size
+        cpus = [self._cpus[i % len(self._cpus)] if self._pin else -1
+                for i in range(nt)]
+        if self._eng:
+            arr = (ctypes.c_int * max(1, nt))(*cpus)
+            ret = _native.lat_resize(self._eng, nr, arr)
+            if ret < 0:
+                raise OSError(-ret, os.strerror(-ret))
+            self._nr = ret
+            return
+        while len(self._workers) > nr:
+            w = self._workers.pop()
+            w.halt()
+            w.join()
+            self._retired = self._retired + w.stats
+        while len(self._workers) < nr:
+            w = _PyWorker(self, cpus[len(self._workers)])
+            w.start()
+            self._workers.append(w)
+        self._nr = len(self._workers)
+
+    def snapshot(self):
+        if self._eng:
+            buf = (ctypes.c_uint64 * _SNAP_LEN)()
+            _native.lat_snapshot(self._eng, buf)
+            v = list(buf)
+            h = 3 + NUM_BUCKETS
+            return LatencyStats(v[0], v[1], v[2], v[3:h], v[h:])
+        s = self._retired
+        for w in self._workers:
+            s = s + w.stats
+        return s
+
+    def close(self):
+        self.resize(0)
+        if self._eng:
+            _native.lat_destroy(self._eng)
+            self._eng = None
@@ -15,12 +15,8 @@ Usage:
 
 import sys
 import os
-import re
+import struct
 import time
-import ctypes
-import threading
-import tempfile
-import subprocess
 from collections import deque
 
 from PyQt5.QtWidgets import (
@@ -32,24 +28,18 @@ from PyQt5.QtGui import (
     QPainter, QColor, QLinearGradient, QPen, QFont, QBrush, QPainterPath,
 )
 
+from poc_latency import (
+    HIST_LABELS, NUM_BUCKETS,
+    _sysfs_read, cstate_detect, cstate_save_disable, cstate_apply,
+    cstate_restore, poc_get, poc_set, poc_active, poc_writable,
+    _cpu_info_text, LatencyEngine, LatencyStats,
+)
+
 # ---------------------------------------------------------------------------
 # Constants
 # ---------------------------------------------------------------------------
 
-VERSION = "0.1.2"
-
-HIST_BOUNDS_NS = [
-    1000, 2000, 4000, 8000, 16_000, 32_000,
-    64_000, 128_000, 256_000, 512_000, 1_024_000, float("inf"),
-]
-HIST_LABELS = [
-    "0\u20131\u00b5s", "1\u20132\u00b5s", "2\u20134\u00b5s", "4\u20138\u00b5s",
-    "8\u201316\u00b5s", "16\u201332\u00b5s", "32\u201364\u00b5s", "64\u2013128\u00b5s",
-    "128\u2013256\u00b5s", "256\u2013512\u00b5s", "0.5\u20131ms", ">1ms",
-]
-NUM_BUCKETS = 12
-
-SYSCTL_POC_PATH = "/proc/sys/kernel/sched_poc_selector"
+VERSION = "0.1.3"
 
 BAR_COLORS = [
     QColor(0, 230, 118),
@@ -77,182 +67,9 @@ UPDATE_MS = 33  # ~30 fps
 WINDOW_MS = 500
 TIMELINE_MAX = 300
 
-# ---------------------------------------------------------------------------
-# libc helpers
-# ---------------------------------------------------------------------------
-
-PR_SET_TIMERSLACK = 29
-MAX_CSTATES = 8
-
-try:
-    _libc = ctypes.CDLL("libc.so.6", use_errno=True)
-    _libc.sched_getcpu.restype = ctypes.c_int
-    _libc.prctl.restype = ctypes.c_int
-    _libc.prctl.argtypes = [ctypes.c_int, ctypes.c_ulong,
-                            ctypes.c_ulong, ctypes.c_ulong, ctypes.c_ulong]
-    def _sched_getcpu():
-        return _libc.sched_getcpu()
-    def _prctl_set_timerslack(ns):
-        return _libc.prctl(PR_SET_TIMERSLACK, ns, 0, 0, 0)
-except Exception:
-    def _sched_getcpu():
-        return -1
-    def _prctl_set_timerslack(ns):
-        return -1
-
-# ---------------------------------------------------------------------------
-# C spin-wait (releases the GIL so the GUI thread stays responsive)
-# ---------------------------------------------------------------------------
-
-_spin_until_ns = None
-
-_nanosleep_ns = None
-
-def _build_spin_lib():
-    """Compile tiny C helpers for GIL-free latency measurement.
-
-    spin_until_ns:  busy-wait until deadline, return actual completion time.
-    nanosleep_ns:   clock_nanosleep + immediate clock_gettime, return wakeup
-                    time measured *inside* C (before GIL re-acquire).
-    Both return int64_t nanoseconds (CLOCK_MONOTONIC) so the caller can
-    compute latency without any GIL-induced measurement skew.
-    """
-    src = r"""
-#include <time.h>
-#include <stdint.h>
-
-static inline int64_t _now_ns(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
-}
-
-int64_t spin_until_ns(int64_t deadline_ns) {
-    int64_t now;
-    for (;;) {
-        now = _now_ns();
-        if (now >= deadline_ns)
-            return now;
-    }
-}
-
-int64_t nanosleep_ns(int64_t sleep_ns) {
-    struct timespec req = {
-        .tv_sec  = sleep_ns / 1000000000LL,
-        .tv_nsec = sleep_ns % 1000000000LL,
-    };
-    clock_nanosleep(CLOCK_MONOTONIC, 0, &req, NULL);
-    return _now_ns();
-}
-"""
-    d = tempfile.mkdtemp(prefix="poc_spin_")
-    src_path = os.path.join(d, "spin.c")
-    lib_path = os.path.join(d, "spin.so")
-    with open(src_path, "w") as f:
-        f.write(src)
-    subprocess.run(
-        ["gcc", "-O2", "-shared", "-fPIC", "-o", lib_path, src_path],
-        check=True, capture_output=True,
-    )
-    lib = ctypes.CDLL(lib_path)
-    lib.spin_until_ns.restype = ctypes.c_int64
-    lib.spin_until_ns.argtypes = [ctypes.c_int64]
-    lib.nanosleep_ns.restype = ctypes.c_int64
-    lib.nanosleep_ns.argtypes = [ctypes.c_int64]
-    return lib.spin_until_ns, lib.nanosleep_ns
-
-try:
-    _spin_until_ns, _nanosleep_ns = _build_spin_lib()
-except Exception:
-    pass  # fall back to Python paths
-
-# ---------------------------------------------------------------------------
-# cpuidle C-state helpers
-# ---------------------------------------------------------------------------
-
-def _sysfs_read(path):
-    try:
-        with open(path) as f:
-            return f.read().strip()
-    except Exception:
-        return None
-
-def _sysfs_write(path, val):
-    try:
-        with open(path, "w") as f:
-            f.write(str(val))
-        return True
-    except Exception:
-        return False
-
-def cstate_detect():
-    """Return list of (name, latency_us) for each C-state on cpu0."""
-    states = []
-    for s in range(MAX_CSTATES):
-        name = _sysfs_read(
-            f"/sys/devices/system/cpu/cpu0/cpuidle/state{s}/name")
-        if name is None:
-            break
-        lat = _sysfs_read(
-            f"/sys/devices/system/cpu/cpu0/cpuidle/state{s}/latency")
-        states.append((name, int(lat) if lat else 0))
-    return states
-
-def cstate_save_disable(nr_cstates):
-    """Save current disable flags from cpu0."""
-    orig = []
-    for s in range(nr_cstates):
-        v = _sysfs_read(
-            f"/sys/devices/system/cpu/cpu0/cpuidle/state{s}/disable")
-        orig.append(int(v) if v is not None else -1)
-    return orig
-
-def cstate_apply(max_cstate, nr_cstates, nr_cpus):
-    """Disable C-states deeper than max_cstate on all CPUs. -1 = no limit."""
-    for cpu in range(nr_cpus):
-        for s in range(nr_cstates):
-            path = (f"/sys/devices/system/cpu/cpu{cpu}"
-                    f"/cpuidle/state{s}/disable")
-            _sysfs_write(path, 1 if (max_cstate >= 0 and s > max_cstate) else 0)
-
-def cstate_restore(orig, nr_cpus):
-    """Restore original disable flags on all CPUs."""
-    for cpu in range(nr_cpus):
-        for s, v in enumerate(orig):
-            if v < 0:
-                continue
-            path = (f"/sys/devices/system/cpu/cpu{cpu}"
-                    f"/cpuidle/state{s}/disable")
-            _sysfs_write(path, v)
-
-# ---------------------------------------------------------------------------
-# POC sysctl helpers
-# ---------------------------------------------------------------------------
-
-def poc_get():
-    try:
-        with open(SYSCTL_POC_PATH) as f:
-            return int(f.read().strip())
-    except Exception:
-        return -1
-
-def poc_set(val):
-    try:
-        with open(SYSCTL_POC_PATH, "w") as f:
-            f.write(str(val))
-        return True
-    except Exception:
-        return False
-
-def poc_active():
-    try:
-        with open("/sys/kernel/poc_selector/status/active") as f:
-            return int(f.read().strip())
-    except Exception:
-        return -1
-
-def poc_writable():
-    return os.access(SYSCTL_POC_PATH, os.W_OK)
+IDLE_SNAPSHOT = "/sys/kernel/poc_selector/idle/snapshot"
+IDLE_RECORD = struct.Struct("<IIQQQ")  # llc, base, members, cpus, cores
+IDLE_READ_SIZE = 1 << 16  # 2048 records; the file is not capped at a page
 
 # ---------------------------------------------------------------------------
 # Plugin loader
@@ -276,155 +93,6 @@ def _load_plugin():
     spec.loader.exec_module(mod)
     return version, mod
 
-# ---------------------------------------------------------------------------
-# CPU info helpers
-# ---------------------------------------------------------------------------
-
-def _cpu_info():
-    """Gather CPU model, topology, and ISA feature info."""
-    info = {
-        "model": "unknown",
-        "cores": 0,
-        "threads": os.cpu_count() or 0,
-        "l2": "",
-        "l3": "",
-        "flags": [],
-    }
-    # Parse /proc/cpuinfo
-    try:
-        with open("/proc/cpuinfo") as f:
-            cpuinfo = f.read()
-        phys_ids = set()
-        core_ids = set()
-        for line in cpuinfo.splitlines():
-            if line.startswith("model name") and info["model"] == "unknown":
-                info["model"] = line.split(":", 1)[1].strip()
-            elif line.startswith("physical id"):
-                phys_ids.add(line.split(":", 1)[1].strip())
-            elif line.startswith("core id"):
-                core_ids.add(line.split(":", 1)[1].strip())
-        if core_ids:
-            info["cores"] = len(core_ids) * max(1, len(phys_ids))
-    except Exception:
-        pass
-    # L2/L3 cache from sysfs
-    for idx in range(10):
-        level = _sysfs_read(f"/sys/devices/system/cpu/cpu0/cache/index{idx}/level")
-        size = _sysfs_read(f"/sys/devices/system/cpu/cpu0/cache/index{idx}/size")
-        shared = _sysfs_read(
-            f"/sys/devices/system/cpu/cpu0/cache/index{idx}/shared_cpu_list")
-        if level is None:
-            break
-        desc = size or "?"
-        if shared:
-            ncpus = 0
-            for part in shared.split(","):
-                if "-" in part:
-                    lo, hi = part.split("-", 1)
-                    ncpus += int(hi) - int(lo) + 1
-                else:
-                    ncpus += 1
-            if ncpus > 1:
-                desc += f" (shared/{ncpus})"
-        if level == "2":
-            info["l2"] = desc
-        elif level == "3":
-            info["l3"] = desc
-    # HW acceleration from POC sysfs
-    hw_dir = "/sys/kernel/poc_selector/hw_accel"
-    try:
-        for name in sorted(os.listdir(hw_dir)):
-            val = _sysfs_read(os.path.join(hw_dir, name))
-            if val:
-                m = re.match(r"HW\s*\((.+)\)", val)
-                if m:
-                    info["flags"].append(m.group(1))
-    except Exception:
-        pass
-    return info
-
-def _cpu_info_text():
-    """Format CPU info as a single display string."""
-    ci = _cpu_info()
-    parts = [ci["model"]]
-    parts.append(f"{ci['cores']}C/{ci['threads']}T")
-    if ci["l2"]:
-        parts.append(f"L2: {ci['l2']}")
-    if ci["l3"]:
-        parts.append(f"L3: {ci['l3']}")
-    if ci["flags"]:
-        parts.append("HW: " + " ".join(ci["flags"]))
-    return "  \u00b7  ".join(parts)
-
-# ---------------------------------------------------------------------------
-# Worker thread
-# ---------------------------------------------------------------------------
-
-class LatencyWorker(threading.Thread):
-    """Measure wakeup latency via nanosleep cycles."""
-
-    def __init__(self, sleep_ns_ref, spin_ref, timer_slack_ref, queue):
-        super().__init__(daemon=True)
-        # All refs are mutable lists [value] shared across workers
-        self._sleep_ref = sleep_ns_ref
-        self._spin_ref = spin_ref
-        self._slack_ref = timer_slack_ref
-        self._queue = queue
-        self._halt = threading.Event()
-
-    def run(self):
-        s_ref = self._sleep_ref
-        sp_ref = self._spin_ref
-        sl_ref = self._slack_ref
-        q = self._queue
-        getcpu = _sched_getcpu
-        gettime = time.clock_gettime_ns
-        CLK = time.CLOCK_MONOTONIC
-        slp = time.sleep
-        c_spin = _spin_until_ns      # None if build failed
-        c_nanosleep = _nanosleep_ns  # None if build failed
-
-        cur_slack = -1  # track to avoid redundant prctl
-
-        while not self._halt.is_set():
-            # apply timer slack if changed
-            want_slack = sl_ref[0]
-            if want_slack != cur_slack:
-                _prctl_set_timerslack(want_slack)
-                cur_slack = want_slack
-
-            sleep_ns = s_ref[0]
-            cpu0 = getcpu()
-            t0 = gettime(CLK)
-
-            if sp_ref[0]:
-                if c_spin is not None:
-                    # C spin-wait: t1 measured inside C (GIL-free)
-                    t1 = c_spin(t0 + sleep_ns)
-                else:
-                    # Python fallback (holds GIL, slow GUI)
-                    deadline = t0 + sleep_ns
-                    while gettime(CLK) < deadline:
-                        pass
-                    t1 = gettime(CLK)
-            else:
-                if c_nanosleep is not None:
-                    # C nanosleep: t1 measured inside C (GIL-free)
-                    t1 = c_nanosleep(sleep_ns)
-                else:
-                    slp(sleep_ns / 1e9)
-                    t1 = gettime(CLK)
-
-            cpu1 = getcpu()
-
-            lat = t1 - t0 - sleep_ns
-            if lat < 0:
-                lat = 0
-            q.append((lat, t1, cpu0, cpu1))
-
-    def halt(self):
-        self._halt.set()
-
 # ---------------------------------------------------------------------------
 # Spectrum analyzer widget
 # ---------------------------------------------------------------------------
@@ -640,6 +308,85 @@ class HeatmapWidget(QWidget):
                    Qt.AlignCenter, "Wakeup Latency Heatmap  \u2190 time")
         p.end()
 
+# ---------------------------------------------------------------------------
+# Per-CPU idle map widget
+# ---------------------------------------------------------------------------
+
+def idle_snapshot_read(fd):
+    """Read the POC idle snapshot; return {cpu: (idle, core_idle)}."""
+    try:
+        buf = os.pread(fd, IDLE_READ_SIZE, 0)
+    except OSError:
+        return None
+    cpus = {}
+    for off in range(0, len(buf) - IDLE_RECORD.size + 1, IDLE_RECORD.size):
+        _llc, base, members, idle, cores = IDLE_RECORD.unpack_from(buf, off)
+        while members:
+            bit = (members & -members).bit_length() - 1
+            members &= members - 1
+            cpus[base + bit] = ((idle >> bit) & 1, (cores >> bit) & 1)
+    return cpus
+
+
+class IdleMapWidget(QWidget):
+    """Scrolling map: X=time, Y=CPU, color=fraction of samples idle."""
+
+    def __init__(self, parent=None):
+        super().__init__(parent)
+        self.setMinimumSize(500, 80)
+        self._cols = deque(maxlen=HEATMAP_MAX_COLS)
+        self._nr = 0
+
+    def clear(self):
+        self._cols.clear()
+        self.update()
+
+    def add(self, frac):
+        """frac: {cpu: idle fraction since the previous column}."""
+        if frac:
+            self._nr = max(self._nr, max(frac) + 1)
+        self._cols.append(frac)
+        self.update()
+
+    def paintEvent(self, _ev):
+        p = QPainter(self)
+        w, h = self.width(), self.height()
+        p.fillRect(0, 0, w, h, BG_COLOR)
+
+        ml, mr, mt, mb = 65, 15, 5, 20
+        cw = w - ml - mr
+        ch = h - mt - mb
+        cx, cy = ml, mt
+        n = len(self._cols)
+
+        p.setPen(TEXT_DIM)
+        p.setFont(QFont("monospace", 8))
+        p.drawText(0, cy, ml - 6, 12, Qt.AlignRight | Qt.AlignTop, "cpu0")
+        if self._nr > 1:
+            p.drawText(0, cy + ch - 12, ml - 6, 12,
+                       Qt.AlignRight | Qt.AlignBottom, f"cpu{self._nr - 1}")
+
+        if n and self._nr:
+            col_w = cw / min(n, HEATMAP_MAX_COLS)
+            rh = ch / self._nr
+            p.setPen(Qt.NoPen)
+            for ci, col in enumerate(self._cols):
+                x = cx + cw - (n - ci) * col_w
+                if x + col_w < cx:
+                    continue
+                for cpu, v in col.items():
+                    p.fillRect(QRectF(x, cy + cpu * rh, col_w + 0.5, rh + 0.5),
+                               _hmap_color(v))
+
+        p.setPen(QPen(GRID_COLOR, 1))
+        p.drawRect(QRectF(cx, cy, cw, ch))
+
+        p.setPen(TEXT_DIM)
+        p.setFont(QFont("monospace", 9))
+        p.drawText(cx, cy + ch + 4, cw, 16,
+                   Qt.AlignCenter, "POC Idle CPUs  \u2190 time")
+        p.end()
+
 # ---------------------------------------------------------------------------
 # Timeline widget
 # ---------------------------------------------------------------------------
@@ -854,6 +601,19 @@ class MainWindow(QMainWindow):
         self._timeline = TimelineWidget()
         vbox.addWidget(self._timeline, 1)
 
+        # ---- per-CPU idle map (POC idle snapshot, root only) ----
+        self._idle_fd = -1
+        self._idle_acc = {}
+        self._idle_n = 0
+        self._idle_map = None
+        try:
+            self._idle_fd = os.open(IDLE_SNAPSHOT, os.O_RDONLY)
+        except OSError:
+            pass
+        if self._idle_fd >= 0:
+            self._idle_map = IdleMapWidget()
+            vbox.addWidget(self._idle_map, 1)
+
         # ---- controls row 1 ----
         ctrl = QHBoxLayout()
 
@@ -947,19 +707,17 @@ class MainWindow(QMainWindow):
         vbox.addWidget(cpu_lbl)
 
         # ---- state ----
-        self._workers = []
-        self._queue = deque(maxlen=600_000)
+        self._engine = LatencyEngine(DEFAULT_SLEEP_US * 1000)
         self._running = False
-        self._buf = []
+        self._last = self._engine.snapshot()
+        self._win = deque()              # (t_ns, LatencyStats delta) per tick
+        self._win_sum = LatencyStats()
         self._rate_cnt = 0
         self._rate_t = time.monotonic()
         self._cur_rate = 0
         self._cur_mean = 0.0
         self._cur_p50 = 0.0
         self._cur_p99 = 0.0
-        self._sleep_ns_ref = [DEFAULT_SLEEP_US * 1000]  # shared mutable
-        self._spin_ref = [False]
-        self._timer_slack_ref = [0]
 
         # live parameter change
         self._w_spin.valueChanged.connect(self._on_workers_changed)
@@ -991,16 +749,9 @@ class MainWindow(QMainWindow):
             self._start()
 
     def _start(self):
-        nr = self._w_spin.value()
-        self._sleep_ns_ref[0] = self._s_spin.value() * 1000
-        self._queue.clear()
-        self._buf.clear()
-
-        for _ in range(nr):
-            w = LatencyWorker(self._sleep_ns_ref, self._spin_ref,
-                              self._timer_slack_ref, self._queue)
-            w.start()
-            self._workers.append(w)
+        self._engine.set_params(sleep_ns=self._s_spin.value() * 1000)
+        self._reset_window()
+        self._engine.resize(self._w_spin.value())
 
         self._running = True
         self._go_btn.setText("\u25a0 Stop")
@@ -1014,9 +765,7 @@ class MainWindow(QMainWindow):
         self._tl_tick.start()
 
     def _stop(self):
-        for w in self._workers:
-            w.halt()
-        self._workers.clear()
+        self._engine.resize(0)
         self._running = False
         self._go_btn.setText("\u25b6 Start")
         self._go_btn.setStyleSheet(
@@ -1028,21 +777,11 @@ class MainWindow(QMainWindow):
     def _on_workers_changed(self, new_nr):
         if not self._running:
             return
-        cur = len(self._workers)
-        if new_nr > cur:
-            for _ in range(new_nr - cur):
-                w = LatencyWorker(self._sleep_ns_ref, self._spin_ref,
-                              self._timer_slack_ref, self._queue)
-                w.start()
-                self._workers.append(w)
-        elif new_nr < cur:
-            for _ in range(cur - new_nr):
-                w = self._workers.pop()
-                w.halt()
+        self._engine.resize(new_nr)
         self._update_workers_lbl()
 
     def _on_sleep_changed(self, val_us):
-        self._sleep_ns_ref[0] = val_us * 1000
+        self._engine.set_params(sleep_ns=val_us * 1000)
         if self._running:
             self._update_workers_lbl()
 
@@ -1055,16 +794,20 @@ class MainWindow(QMainWindow):
             self._view_stack.setCurrentIndex(0)
             self._view_btn.setText("Heatmap")
 
+    def _reset_window(self):
+        self._last = self._engine.snapshot()
+        self._win.clear()
+        self._win_sum = LatencyStats()
+
     def _clear_graphs(self):
-        self._buf.clear()
-        try:
-            while True:
-                self._queue.popleft()
-        except IndexError:
-            pass
+        self._reset_window()
         self._bars.clear()
         self._heatmap.clear()
         self._timeline.clear()
+        if self._idle_map:
+            self._idle_map.clear()
+        self._idle_acc = {}
+        self._idle_n = 0
         self._cur_mean = 0.0
         self._cur_p50 = 0.0
         self._cur_p99 = 0.0
@@ -1087,15 +830,15 @@ class MainWindow(QMainWindow):
 
     def _on_timer_slack_changed(self, state):
         # prctl(PR_SET_TIMERSLACK, 0) resets to default; 1 = minimum
-        self._timer_slack_ref[0] = 1 if state == Qt.Checked else 0
+        self._engine.set_params(timer_slack=1 if state == Qt.Checked else 0)
         self._update_workers_lbl()
 
     def _on_spin_changed(self, state):
-        self._spin_ref[0] = (state == Qt.Checked)
+        self._engine.set_params(spin=(state == Qt.Checked))
         self._update_workers_lbl()
 
     def _update_workers_lbl(self):
-        nr = len(self._workers) if self._running else self._w_spin.value()
+        nr = len(self._engine) if self._running else self._w_spin.value()
         parts = [f"{nr} workers",
                  f"sleep {self._s_spin.value()}\u00b5s"]
         if self._cs_chk.isChecked():
@@ -1104,6 +847,8 @@ class MainWindow(QMainWindow):
             parts.append("no slack")
         if self._spin_chk.isChecked():
             parts.append("spin")
+        if not LatencyEngine.native:
+            parts.append("python workers")
         self._workers_lbl.setText("  \u00b7  ".join(parts))
 
     # ---- data collection ----
@@ -1112,54 +857,38 @@ class MainWindow(QMainWindow):
         now = time.clock_gettime_ns(time.CLOCK_MONOTONIC)
         cutoff = now - WINDOW_MS * 1_000_000
 
-        # bulk drain
-        batch = []
-        try:
-            while True:
-                batch.append(self._queue.popleft())
-        except IndexError:
-            pass
+        # per-tick delta of the workers' cumulative counters
+        snap = self._engine.snapshot()
+        d = snap - self._last
+        self._last = snap
+        self._win.append((now, d))
+        self._win_sum = self._win_sum + d
+        self._rate_cnt += d.samples
 
-        self._buf.extend(batch)
-        self._rate_cnt += len(batch)
+        self._sample_idle()
 
         # trim old
-        self._buf = [s for s in self._buf if s[1] >= cutoff]
+        while self._win and self._win[0][0] < cutoff:
+            self._win_sum = self._win_sum - self._win.popleft()[1]
 
-        n = len(self._buf)
+        st = self._win_sum
+        n = st.samples
         if n < 10:
             return
 
         # histogram
-        hist = [0] * NUM_BUCKETS
-        lats = []
-        migr = 0
-        for lat, _ts, c0, c1 in self._buf:
-            lats.append(lat)
-            if c0 != c1 and c0 >= 0:
-                migr += 1
-            for b in range(NUM_BUCKETS):
-                if lat <= HIST_BOUNDS_NS[b]:
-                    hist[b] += 1
-                    break
-
-        total = sum(hist)
+        total = sum(st.hist)
         if total == 0:
             return
-        frac = [h / total for h in hist]
+        frac = [h / total for h in st.hist]
         self._bars.set_values(frac)
         self._heatmap.set_values(frac)
 
-        # percentiles (subsample if huge)
-        if n > 50_000:
-            step = n // 50_000
-            lats = lats[::step]
-        lats.sort()
-        sn = len(lats)
-        p50 = lats[int(sn * 0.50)] / 1000
-        p95 = lats[int(sn * 0.95)] / 1000
-        p99 = lats[min(int(sn * 0.99), sn - 1)] / 1000
-        mean = sum(lats) / sn / 1000
+        # percentiles (fine-bin resolution)
+        p50 = st.percentile_ns(0.50) / 1000
+        p95 = st.percentile_ns(0.95) / 1000
+        p99 = st.percentile_ns(0.99) / 1000
+        mean = st.mean_ns() / 1000
         self._cur_mean = mean
         self._cur_p50 = p50
         self._cur_p99 = p99
@@ -1168,6 +897,7 @@ class MainWindow(QMainWindow):
             f"mean: {mean:.2f}\u00b5s  p50: {p50:.2f}\u00b5s  "
             f"p95: {p95:.2f}\u00b5s  p99: {p99:.2f}\u00b5s")
 
+        migr = st.migrations
         migr_pct = migr / n * 100 if n else 0
         self._migr_lbl.setText(
             f"migration: {migr_pct:.1f}%  ({migr}/{n} samples)")
@@ -1181,8 +911,23 @@ class MainWindow(QMainWindow):
             self._rate_cnt = 0
             self._rate_t = t
 
+    def _sample_idle(self):
+        if self._idle_fd < 0:
+            return
+        snap = idle_snapshot_read(self._idle_fd)
+        if not snap:
+            return
+        for cpu, (idle, _core) in snap.items():
+            self._idle_acc[cpu] = self._idle_acc.get(cpu, 0) + idle
+        self._idle_n += 1
+
     def _on_tl(self):
         self._timeline.add(self._cur_mean, self._cur_p50, self._cur_p99, poc_get())
+        if self._idle_map and self._idle_n:
+            n = self._idle_n
+            self._idle_map.add({c: v / n for c, v in self._idle_acc.items()})
+            self._idle_acc = {}
+            self._idle_n = 0
 
     # ---- POC ----
 
@@ -1215,6 +960,9 @@ class MainWindow(QMainWindow):
 
     def closeEvent(self, ev):
         self._stop()
+        self._engine.close()
+        if self._idle_fd >= 0:
+            os.close(self._idle_fd)
         # restore C-state limits
         if self._cs_orig_disable is not None:
             cstate_restore(self._cs_orig_disable, self._nr_cpus)
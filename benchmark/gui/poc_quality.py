@@ -0,0 +1,350 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0
+"""
+POC Quality - headless placement-quality regression benchmark
+
+Runs hackbench, schbench, pipe ping-pong and nanosleep loads with
+kernel.sched_poc_quality=1 and reads /sys/kernel/poc_selector/quality/,
+where the kernel checks every select_idle_cpu_poc() decision against
+the runqueues at selection time (idle_cpu() and not committed to
+another wakee).  Reports per workload the stale, collide, smt_busy and
+missed rates, the Level 3/6 round-robin spread, and a
+0-100 placement score.  With --compare, diffs the scores against an
+earlier JSON run and exits 1 on a regression.
+
+Requirements: Python 3.8+ (no PyQt5 or display needed).  hackbench
+(rt-tests, or "perf bench sched messaging") and schbench are run from
+PATH when present; pipe and nanosleep use the poc_latency.py workers.
+Usage:
+    sudo python3 poc_quality.py -o base.json
+    sudo python3 poc_quality.py --sweep sched_poc_rr_improved=0,1 \\
+        --workload pipe,nanosleep --repeat 3 --format csv -o rr.csv
+    sudo python3 poc_quality.py --compare base.json --tolerance 1.0
+"""
+
+import os
+import sys
+import csv
+import json
+import time
+import shlex
+import shutil
+import argparse
+import itertools
+import platform
+import subprocess
+
+from poc_latency import _sysfs_read, _sysfs_write, _cpu_info, LatencyEngine
+from poc_sweep import sysctl_get, sysctl_set, parse_sweep
+
+VERSION = "0.1.0"
+
+SYSCTL_DIR = "/proc/sys/kernel"
+POC_SYSFS = "/sys/kernel/poc_selector"
+QUALITY_DIR = POC_SYSFS + "/quality"
+SYSCTL_QUALITY = "sched_poc_quality"
+
+# Counters under quality/, in output order
+EVENTS = ["select", "stale", "collide", "smt_busy", "missed", "fallback"]
+# Events that count against the score
+BAD_EVENTS = ["stale", "collide", "smt_busy", "missed"]
+
+# ---------------------------------------------------------------------------
+# quality/ readers
+# ---------------------------------------------------------------------------
+
+def quality_reset():
+    return _sysfs_write(os.path.join(QUALITY_DIR, "reset"), 1)
+
+def quality_snapshot():
+    """Every event counter, plus the Level 3/6 picks per LLC from "rr"."""
+    snap = {}
+    for n in EVENTS:
+        v = _sysfs_read(os.path.join(QUALITY_DIR, n))
+        try:
+            snap[n] = int(v)
+        except (TypeError, ValueError):
+            snap[n] = 0
+    llcs = {}
+    for line in (_sysfs_read(os.path.join(QUALITY_DIR, "rr")) or "").splitlines():
+        key, _, vals = line.partition(":")
+        try:
+            llcs[int(key)] = [int(v) for v in vals.split()]
+        except ValueError:
+            continue
+    snap["rr"] = llcs
+    return snap
+
+def rr_spread(llcs):
+    """Chi-square/dof of the Level 3/6 picks against an even split per LLC.
+
+    Pooled over LLCs with at least one pick per CPU on average; None when
+    no LLC qualifies.  About 1 is as even as random picks, below 1 is
+    smoother.  Affinity-restricted loads skew it upwards.
+    """
+    chi = 0.0
+    dof = 0
+    for picks in llcs.values():
+        n = len(picks)
+        total = sum(picks)
+        if n < 2 or total < n:
+            continue
+        mean = total / n
+        chi += sum((p - mean) ** 2 for p in picks) / mean
+        dof += n - 1
+    return round(chi / dof, 3) if dof else None
+
+def score(ev):
+    """Rates in % of decisions and the 0-100 score (100 = no bad event)."""
+    decisions = ev["select"] + ev["fallback"]
+    res = {"decisions": decisions}
+    for n in BAD_EVENTS:
+        res[n + "_pct"] = round(100.0 * ev[n] / decisions, 3) if decisions else None
+    bad = sum(ev[n] for n in BAD_EVENTS)
+    res["score"] = round(100.0 * (1 - bad / decisions), 2) if decisions else None
+    return res
+
+# ---------------------------------------------------------------------------
+# Workloads
+# ---------------------------------------------------------------------------
+
+def find_hackbench():
+    if shutil.which("hackbench"):
+        return ["hackbench"]
+    if shutil.which("perf"):
+        return ["perf", "bench", "sched", "messaging"]
+    return None
+
+def run_external(cmd, duration):
+    """Run @cmd back to back until @duration has passed."""
+    t_end = time.monotonic() + duration
+    while time.monotonic() < t_end:
+        ret = subprocess.run(cmd, stdout=subprocess.DEVNULL,
+                             stderr=subprocess.DEVNULL).returncode
+        if ret:
+            raise SystemExit("%s exited with %d" % (" ".join(cmd), ret))
+
+def run_engine(workload, workers, sleep_ns, duration):
+    eng = LatencyEngine(sleep_ns, workload=workload)
+    try:
+        eng.resize(workers)
+        time.sleep(duration)
+    finally:
+        eng.close()
+
+def build_workloads(args):
+    """name -> callable(duration); None when the tool is not installed."""
+    hb = find_hackbench()
+    hb_args = shlex.split(args.hackbench_args)
+    sb = shutil.which("schbench")
+    sb_args = shlex.split(args.schbench_args)
+    return {
+        "hackbench": (lambda d: run_external(hb + hb_args, d)) if hb else None,
+        "schbench": (lambda d: run_external(
+            [sb] + sb_args + ["-r", str(max(1, int(d)))], d)) if sb else None,
+        "pipe": lambda d: run_engine("pipe", args.workers, 0, d),
+        "nanosleep": lambda d: run_engine("timer", args.workers,
+                                          args.sleep_us * 1000, d),
+    }
+
+# ---------------------------------------------------------------------------
+# Measurement
+# ---------------------------------------------------------------------------
+
+def measure(run, warmup, duration):
+    """Run one workload; return (event deltas, rr picks, elapsed)."""
+    if warmup:
+        run(warmup)
+    quality_reset()
+    t0 = time.monotonic()
+    run(duration)
+    elapsed = time.monotonic() - t0
+    snap = quality_snapshot()
+    rr = snap.pop("rr")
+    return snap, rr, elapsed
+
+# ---------------------------------------------------------------------------
+# Argument parsing
+# ---------------------------------------------------------------------------
+
+def build_parser():
+    ncpu = os.cpu_count() or 1
+    ap = argparse.ArgumentParser(
+        description="Placement-quality regression benchmark for POC.")
+    ap.add_argument("--sweep", action="append", default=[], metavar="NAME=V,..",
+                    help="kernel sysctl and values to sweep (repeatable)")
+    ap.add_argument("--workload", default="hackbench,schbench,pipe,nanosleep",
+                    metavar="W,..", help="workloads to run (default %(default)s)")
+    ap.add_argument("--workers", type=int, default=max(1, ncpu // 2), metavar="N",
+                    help="pipe pairs / nanosleep threads (default %(default)s)")
+    ap.add_argument("--sleep-us", type=int, default=50, metavar="US",
+                    help="nanosleep period (default %(default)s)")
+    ap.add_argument("--hackbench-args", default="-g 4 -l 1000", metavar="ARGS",
+                    help="arguments for hackbench (default %(default)r)")
+    ap.add_argument("--schbench-args", default="-m 2 -t %d" % max(1, ncpu // 4),
+                    metavar="ARGS",
+                    help="arguments for schbench; -r is added (default %(default)r)")
+    ap.add_argument("--duration", type=float, default=10.0, metavar="SEC",
+                    help="measured seconds per run (default %(default)s)")
+    ap.add_argument("--warmup", type=float, default=1.0, metavar="SEC",
+                    help="discarded seconds before each run (default %(default)s)")
+    ap.add_argument("--repeat", type=int, default=1, metavar="N",
+                    help="passes over the whole matrix, interleaved (default %(default)s)")
+    ap.add_argument("--compare", metavar="FILE",
+                    help="JSON from an earlier run: report score deltas, "
+                         "exit 1 if any drops by more than --tolerance")
+    ap.add_argument("--tolerance", type=float, default=0.5, metavar="PTS",
+                    help="allowed score drop for --compare (default %(default)s)")
+    ap.add_argument("--format", choices=("json", "csv"), default="json")
+    ap.add_argument("-o", "--output", default="-", metavar="FILE",
+                    help="output file (default stdout)")
+    return ap
+
+# ---------------------------------------------------------------------------
+# Output
+# ---------------------------------------------------------------------------
+
+def run_key(r):
+    return (r["workload"],) + tuple(sorted(r["sysctl"].items()))
+
+def mean_scores(runs):
+    """run_key -> mean score over repeats."""
+    acc = {}
+    for r in runs:
+        if r["score"] is not None:
+            acc.setdefault(run_key(r), []).append(r["score"])
+    return {k: sum(v) / len(v) for k, v in acc.items()}
+
+def compare(runs, path, tolerance):
+    """Print score deltas against @path; True if nothing regressed."""
+    with open(path) as f:
+        old = mean_scores(json.load(f).get("runs", []))
+    ok = True
+    for key, new in sorted(mean_scores(runs).items()):
+        desc = " ".join([key[0]] + ["%s=%s" % kv for kv in key[1:]])
+        if key not in old:
+            print("%-40s %6.2f  (no baseline)" % (desc, new), file=sys.stderr)
+            continue
+        delta = new - old[key]
+        bad = delta < -tolerance
+        ok &= not bad
+        print("%-40s %6.2f  %+6.2f%s" % (desc, new, delta,
+              "  REGRESSION" if bad else ""), file=sys.stderr)
+    return ok
+
+def write_json(f, meta, runs):
+    json.dump(dict(meta, runs=runs), f, indent=2)
+    f.write("\n")
+
+def write_csv(f, sweep, runs):
+    names = [n for n, _ in sweep]
+    stats = ["workload", "repeat", "elapsed", "decisions", "score"]
+    stats += [n + "_pct" for n in BAD_EVENTS] + ["rr_chi2"]
+    cols = names + stats + EVENTS
+    w = csv.writer(f)
+    w.writerow(cols)
+    for r in runs:
+        row = [r["sysctl"][n] for n in names]
+        row += ["" if r[k] is None else r[k] for k in stats]
+        row += [r["events"][e] for e in EVENTS]
+        w.writerow(row)
+
+# ---------------------------------------------------------------------------
+# Main
+# ---------------------------------------------------------------------------
+
+def main():
+    args = build_parser().parse_args()
+    sweep = parse_sweep(args.sweep)
+    avail = build_workloads(args)
+    workloads = []
+    for wl in (w.strip() for w in args.workload.split(",")):
+        if not wl:
+            continue
+        if wl not in avail:
+            raise SystemExit("unknown workload %r (want %s)"
+                             % (wl, ", ".join(avail)))
+        if avail[wl] is None:
+            print("skipping %s: not installed" % wl, file=sys.stderr)
+            continue
+        if wl == "pipe" and not LatencyEngine.native:
+            raise SystemExit("workload pipe needs gcc for the native helper")
+        workloads.append(wl)
+    if not workloads or args.workers < 1 or args.sleep_us < 0:
+        raise SystemExit("bad --workload/--workers")
+    if args.repeat < 1 or args.duration <= 0 or args.warmup < 0:
+        raise SystemExit("bad --repeat/--duration/--warmup")
+    if not os.path.isdir(QUALITY_DIR):
+        raise SystemExit("%s not found (kernel without sched_poc_quality)"
+                         % QUALITY_DIR)
+
+    # Save every knob we may touch so the system is left as found
+    touched = [n for n, _ in sweep]
+    if SYSCTL_QUALITY not in touched:
+        touched.append(SYSCTL_QUALITY)
+    orig = {}
+    for n in touched:
+        v = sysctl_get(n)
+        if v is None:
+            raise SystemExit("%s/%s not found" % (SYSCTL_DIR, n))
+        orig[n] = v
+        if not os.access(os.path.join(SYSCTL_DIR, n), os.W_OK):
+            raise SystemExit("%s/%s not writable (run as root)" % (SYSCTL_DIR, n))
+
+    matrix = list(itertools.product(*[vals for _, vals in sweep]))
+    total = len(matrix) * len(workloads) * args.repeat
+    runs = []
+    try:
+        sysctl_set(SYSCTL_QUALITY, 1)
+        for rep in range(args.repeat):
+            for combo in matrix:
+                setting = dict(zip((n for n, _ in sweep), combo))
+                for n, v in setting.items():
+                    if not sysctl_set(n, v):
+                        raise SystemExit("failed to set %s=%s" % (n, v))
+                for wl in workloads:
+                    desc = ["%s=%s" % kv for kv in setting.items()]
+                    desc += ["workload=%s" % wl]
+                    print("[%d/%d] %s" % (len(runs) + 1, total, " ".join(desc)),
+                          file=sys.stderr, flush=True)
+                    ev, rr, elapsed = measure(avail[wl], args.warmup,
+                                              args.duration)
+                    res = {"sysctl": setting, "workload": wl, "repeat": rep,
+                           "elapsed": round(elapsed, 2)}
+                    res.update(score(ev))
+                    res["rr_chi2"] = rr_spread(rr)
+                    res["events"] = ev
+                    runs.append(res)
+    finally:
+        for n, v in orig.items():
+            sysctl_set(n, v)
+
+    meta = {
+        "tool": "poc_quality",
+        "version": VERSION,
+        "kernel": platform.release(),
+        "poc_version": _sysfs_read(POC_SYSFS + "/status/version"),
+        "cpu": _cpu_info(),
+        "params": {
+            "duration": args.duration, "warmup": args.warmup,
+            "workers": args.workers, "sleep_us": args.sleep_us,
+            "hackbench_args": args.hackbench_args,
+            "schbench_args": args.schbench_args,
+        },
+    }
+    out = sys.stdout if args.output == "-" else open(args.output, "w", newline="")
+    try:
+        if args.format == "json":
+            write_json(out, meta, runs)
+        else:
+            write_csv(out, sweep, runs)
+    finally:
+        if out is not sys.stdout:
+            out.close()
+
+    if args.compare and not compare(runs, args.compare, args.tolerance):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
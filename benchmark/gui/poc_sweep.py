@@ -0,0 +1,310 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0
+"""
+POC Sweep - headless wakeup-latency A/B benchmark
+
+Runs the poc_monitor.py LatencyEngine workers for a fixed duration per
+configuration, over every combination of the given POC sysctl values,
+workloads and worker counts, and writes JSON or CSV with p50/p99/p99.9, the
+HIST_BOUNDS_NS histogram and the /sys/kernel/poc_selector/count/* deltas.
+
+Requirements: Python 3.8+ (no PyQt5 or display needed)
+Usage:
+    sudo python3 poc_sweep.py --sweep sched_poc_selector=0,1 --workers 4,16
+    sudo python3 poc_sweep.py --sweep sched_poc_selector=1 \\
+        --sweep sched_poc_rr_improved=0,1 --repeat 3 --format csv -o rr.csv
+    sudo python3 poc_sweep.py --workload pipe,chain,fanout --sleep-us 0 \
+        --workers 1,8 --group 8
+"""
+
+import os
+import sys
+import csv
+import json
+import time
+import argparse
+import itertools
+import platform
+
+from poc_latency import (
+    HIST_BOUNDS_NS,
+    _sysfs_read, _sysfs_write,
+    cstate_detect, cstate_save_disable, cstate_apply, cstate_restore,
+    _cpu_info, LatencyEngine, WORKLOADS,
+)
+
+VERSION = "0.1.0"
+
+SYSCTL_DIR = "/proc/sys/kernel"
+POC_SYSFS = "/sys/kernel/poc_selector"
+COUNT_DIR = POC_SYSFS + "/count"
+SYSCTL_COUNT = "sched_poc_count"
+
+# Column names for the histogram buckets ("le_1us" ... "gt_1ms")
+HIST_KEYS = ["le_%dus" % (b // 1000) for b in HIST_BOUNDS_NS[:-1]] + ["gt_1ms"]
+
+# ---------------------------------------------------------------------------
+# sysctl / sysfs helpers
+# ---------------------------------------------------------------------------
+
+def sysctl_name(name):
+    """Accept both "sched_poc_x" and "kernel.sched_poc_x"."""
+    return name[len("kernel."):] if name.startswith("kernel.") else name
+
+def sysctl_get(name):
+    return _sysfs_read(os.path.join(SYSCTL_DIR, name))
+
+def sysctl_set(name, val):
+    return _sysfs_write(os.path.join(SYSCTL_DIR, name), val)
+
+def count_snapshot():
+    """Read every counter under count/ except the "reset" trigger."""
+    snap = {}
+    try:
+        names = sorted(os.listdir(COUNT_DIR))
+    except OSError:
+        return snap
+    for n in names:
+        if n == "reset":
+            continue
+        v = _sysfs_read(os.path.join(COUNT_DIR, n))
+        try:
+            snap[n] = int(v)
+        except (TypeError, ValueError):
+            pass
+    return snap
+
+# ---------------------------------------------------------------------------
+# Measurement
+# ---------------------------------------------------------------------------
+
+def measure(workload, group, workers, sleep_ns, spin, slack_ns, pin,
+            warmup, duration):
+    """Run @workers latency workers; return (LatencyStats, elapsed, counts)."""
+    eng = LatencyEngine(sleep_ns, spin, slack_ns, pin, workload, group)
+    try:
+        eng.resize(workers)
+        time.sleep(warmup)
+        s0 = eng.snapshot()
+        c0 = count_snapshot()
+        t0 = time.monotonic()
+        time.sleep(duration)
+        s1 = eng.snapshot()
+        elapsed = time.monotonic() - t0
+        c1 = count_snapshot()
+    finally:
+        eng.close()
+    counts = {k: c1[k] - c0.get(k, 0) for k in c1}
+    return s1 - s0, elapsed, counts
+
+def summarize(st, elapsed):
+    """Percentiles, histogram and migration rate of one run's LatencyStats."""
+    n = st.samples
+    res = {"samples": n, "rate": round(n / elapsed, 1) if elapsed else 0.0}
+    if n:
+        def us(ns):
+            return round(ns / 1000, 2)
+        res.update(
+            mean_us=us(st.mean_ns()),
+            p50_us=us(st.percentile_ns(0.50)),
+            p99_us=us(st.percentile_ns(0.99)),
+            p999_us=us(st.percentile_ns(0.999)),
+            max_us=us(st.max_ns()),
+            migration_pct=round(100.0 * st.migrations / n, 2),
+        )
+    else:
+        res.update(mean_us=None, p50_us=None, p99_us=None, p999_us=None,
+                   max_us=None, migration_pct=None)
+    res["hist"] = dict(zip(HIST_KEYS, st.hist))
+    return res
+
+# ---------------------------------------------------------------------------
+# Argument parsing
+# ---------------------------------------------------------------------------
+
+def parse_sweep(specs):
+    """["NAME=V1,V2", ...] -> [(name, [v1, v2]), ...] in command-line order."""
+    sweep = []
+    for spec in specs:
+        name, sep, vals = spec.partition("=")
+        name = sysctl_name(name.strip())
+        vals = [v.strip() for v in vals.split(",") if v.strip()]
+        if not sep or not name or not vals:
+            raise SystemExit("bad --sweep %r (want NAME=V1,V2,...)" % spec)
+        if any(name == s[0] for s in sweep):
+            raise SystemExit("--sweep %s given twice" % name)
+        sweep.append((name, vals))
+    return sweep
+
+def parse_ints(s, what):
+    try:
+        vals = [int(v) for v in s.split(",") if v.strip()]
+    except ValueError:
+        raise SystemExit("bad %s %r" % (what, s))
+    if not vals or min(vals) < 1:
+        raise SystemExit("bad %s %r" % (what, s))
+    return vals
+
+def build_parser():
+    ncpu = os.cpu_count() or 1
+    ap = argparse.ArgumentParser(
+        description="Headless wakeup-latency A/B sweep over POC sysctls.")
+    ap.add_argument("--sweep", action="append", default=[], metavar="NAME=V,..",
+                    help="kernel sysctl and values to sweep (repeatable)")
+    ap.add_argument("--workload", default="timer", metavar="W,..",
+                    help="workloads to run: %s (default %%(default)s)"
+                         % ", ".join(WORKLOADS))
+    ap.add_argument("--group", type=int, default=4, metavar="N",
+                    help="chain length / fan-out width (default %(default)s)")
+    ap.add_argument("--workers", default=str(max(1, ncpu * 3 // 4)),
+                    metavar="N,..",
+                    help="worker counts; pipe/chain/fanout count thread groups "
+                         "(default %(default)s)")
+    ap.add_argument("--duration", type=float, default=5.0, metavar="SEC",
+                    help="measured seconds per run (default %(default)s)")
+    ap.add_argument("--warmup", type=float, default=1.0, metavar="SEC",
+                    help="discarded seconds before each run (default %(default)s)")
+    ap.add_argument("--repeat", type=int, default=1, metavar="N",
+                    help="passes over the whole matrix, interleaved (default %(default)s)")
+    ap.add_argument("--sleep-us", type=int, default=50, metavar="US",
+                    help="timer sleep, or think time between rounds of "
+                         "the other workloads (default %(default)s)")
+    ap.add_argument("--spin", action="store_true",
+                    help="spin-wait instead of nanosleep")
+    ap.add_argument("--pin", action="store_true",
+                    help="pin worker i to the i-th allowed CPU (no-selection baseline)")
+    ap.add_argument("--no-slack", action="store_true",
+                    help="set timer slack to 1 ns (default: kernel default)")
+    ap.add_argument("--max-cstate", type=int, default=None, metavar="N",
+                    help="disable cpuidle states deeper than N during the sweep")
+    ap.add_argument("--format", choices=("json", "csv"), default="json")
+    ap.add_argument("-o", "--output", default="-", metavar="FILE",
+                    help="output file (default stdout)")
+    return ap
+
+# ---------------------------------------------------------------------------
+# Output
+# ---------------------------------------------------------------------------
+
+def write_json(f, meta, runs):
+    json.dump(dict(meta, runs=runs), f, indent=2)
+    f.write("\n")
+
+def write_csv(f, sweep, runs):
+    names = [n for n, _ in sweep]
+    counters = sorted({k for r in runs for k in r["count"]})
+    stats = ["workload", "workers", "threads", "repeat", "samples", "rate",
+             "mean_us", "p50_us", "p99_us", "p999_us", "max_us",
+             "migration_pct"]
+    cols = names + stats + HIST_KEYS + ["count_" + c for c in counters]
+    w = csv.writer(f)
+    w.writerow(cols)
+    for r in runs:
+        row = [r["sysctl"][n] for n in names]
+        row += [r[k] for k in stats]
+        row += [r["hist"][k] for k in HIST_KEYS]
+        row += [r["count"].get(c, "") for c in counters]
+        w.writerow(row)
+
+# ---------------------------------------------------------------------------
+# Main
+# ---------------------------------------------------------------------------
+
+def main():
+    args = build_parser().parse_args()
+    sweep = parse_sweep(args.sweep)
+    workers = parse_ints(args.workers, "--workers")
+    workloads = [w.strip() for w in args.workload.split(",") if w.strip()]
+    for wl in workloads:
+        if wl not in WORKLOADS:
+            raise SystemExit("unknown workload %r (want %s)"
+                             % (wl, ", ".join(WORKLOADS)))
+        if wl != "timer" and not LatencyEngine.native:
+            raise SystemExit("workload %r needs gcc for the native helper" % wl)
+    if not workloads or args.sleep_us < 0 or args.group < 1:
+        raise SystemExit("bad --workload/--sleep-us/--group")
+    if args.repeat < 1 or args.duration <= 0 or args.warmup < 0:
+        raise SystemExit("bad --repeat/--duration/--warmup")
+
+    # Save every knob we may touch so the system is left as found
+    touched = [n for n, _ in sweep]
+    if sysctl_get(SYSCTL_COUNT) is not None and SYSCTL_COUNT not in touched:
+        touched.append(SYSCTL_COUNT)
+    orig = {}
+    for n in touched:
+        v = sysctl_get(n)
+        if v is None:
+            raise SystemExit("%s/%s not found" % (SYSCTL_DIR, n))
+        orig[n] = v
+        if not os.access(os.path.join(SYSCTL_DIR, n), os.W_OK):
+            raise SystemExit("%s/%s not writable (run as root)" % (SYSCTL_DIR, n))
+
+    nr_cpus = os.cpu_count() or 1
+    cst_orig = None
+    if args.max_cstate is not None:
+        nr_cst = len(cstate_detect())
+        if nr_cst:
+            cst_orig = cstate_save_disable(nr_cst)
+            cstate_apply(args.max_cstate, nr_cst, nr_cpus)
+
+    matrix = list(itertools.product(*[vals for _, vals in sweep]))
+    total = len(matrix) * len(workloads) * len(workers) * args.repeat
+    runs = []
+    try:
+        if SYSCTL_COUNT in orig:
+            sysctl_set(SYSCTL_COUNT, 1)
+        for rep in range(args.repeat):
+            for combo in matrix:
+                setting = dict(zip((n for n, _ in sweep), combo))
+                for n, v in setting.items():
+                    if not sysctl_set(n, v):
+                        raise SystemExit("failed to set %s=%s" % (n, v))
+                for wl, nw in itertools.product(workloads, workers):
+                    desc = ["%s=%s" % kv for kv in setting.items()]
+                    desc += ["workload=%s" % wl, "workers=%d" % nw]
+                    print("[%d/%d] %s" % (len(runs) + 1, total, " ".join(desc)),
+                          file=sys.stderr, flush=True)
+                    stats, elapsed, counts = measure(
+                        wl, args.group, nw, args.sleep_us * 1000, args.spin,
+                        1 if args.no_slack else 0, args.pin,
+                        args.warmup, args.duration)
+                    res = {"sysctl": setting, "workload": wl, "workers": nw,
+                           "threads": nw * WORKLOADS[wl][1](args.group),
+                           "repeat": rep}
+                    res.update(summarize(stats, elapsed))
+                    res["count"] = counts
+                    runs.append(res)
+    finally:
+        for n, v in orig.items():
+            sysctl_set(n, v)
+        if cst_orig is not None:
+            cstate_restore(cst_orig, nr_cpus)
+
+    meta = {
+        "tool": "poc_sweep",
+        "version": VERSION,
+        "kernel": platform.release(),
+        "poc_version": _sysfs_read(POC_SYSFS + "/status/version"),
+        "cpu": _cpu_info(),
+        "params": {
+            "duration": args.duration, "warmup": args.warmup,
+            "group": args.group,
+            "sleep_us": args.sleep_us, "spin": args.spin,
+            "no_slack": args.no_slack, "pin": args.pin,
+            "max_cstate": args.max_cstate,
+            "engine": "native" if LatencyEngine.native else "python",
+        },
+    }
+    out = sys.stdout if args.output == "-" else open(args.output, "w", newline="")
+    try:
+        if args.format == "json":
+            write_json(out, meta, runs)
+        else:
+            write_csv(out, sweep, runs)
+    finally:
+        if out is not sys.stdout:
+            out.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0
+"""
+Extract the POC selector sources from a git format-patch file.
+
+Writes into OUTDIR:
+  poc_selector.c                    - kernel/sched/poc_selector.c (new file)
+  poc_sched.h                       - CONFIG_SCHED_POC_SELECTOR blocks added
+                                      to kernel/sched/sched.h at file scope
+  poc_fields_<struct>.h             - CONFIG_SCHED_POC_SELECTOR blocks added
+                                      inside "struct <struct> {" in any header
+
+Only added ("+") lines are taken, grouped into contiguous runs.  A run
+is kept when it opens with "#ifdef CONFIG_SCHED_POC_SELECTOR", which is
+how every hunk of the patch guards its additions.
+
+Usage: extract.py PATCH OUTDIR
+"""
+
+import os
+import re
+import sys
+
+HUNK_RE = re.compile(r'^@@ -\d+(?:,\d+)? \+\d+(?:,\d+)? @@ ?(.*)$')
+STRUCT_RE = re.compile(r'^struct (\w+) \{')
+POC_IFDEF = '#ifdef CONFIG_SCHED_POC_SELECTOR'
+
+# Structs the shim defines itself; fields for these are always emitted
+# (possibly empty) so kernel_shim.h can #include them unconditionally.
+SHIM_STRUCTS = ('rq', 'sched_domain_shared', 'task_struct')
+
+
+def sections(lines):
+    cur = None
+    for line in lines:
+        if line.startswith('diff --git '):
+            if cur:
+                yield cur
+            cur = [line]
+        elif cur is not None:
+            if line == '-- ':
+                break
+            cur.append(line)
+    if cur:
+        yield cur
+
+
+def runs(sec):
+    """Yield (hunk_context, [added lines]) for each contiguous + run."""
+    ctx = ''
+    run = None
+    for line in sec:
+        m = HUNK_RE.match(line)
+        if m:
+            if run:
+                yield ctx, run
+            run = None
+            ctx = m.group(1)
+            continue
+        if line.startswith('+') and not line.startswith('+++'):
+            if run is None:
+                run = []
+            run.append(line[1:])
+        else:
+            if run:
+                yield ctx, run
+            run = None
+    if run:
+        yield ctx, run
+
+
+def main():
+    patch, outdir = sys.argv[1], sys.argv[2]
+    os.makedirs(outdir, exist_ok=True)
+    with open(patch) as f:
+        lines = f.read().split('\n')
+
+    fields = {s: [] for s in SHIM_STRUCTS}
+    sched_h = []
+    found_selector = False
+
+    for sec in sections(lines):
+        path = sec[0].split(' b/', 1)[1]
+        if path == 'kernel/sched/poc_selector.c':
+            body = [l for _, r in runs(sec) for l in r]
+            with open(os.path.join(outdir, 'poc_selector.c'), 'w') as f:
+                f.write('\n'.join(body) + '\n')
+            found_selector = True
+            continue
+        if not path.endswith('.h'):
+            continue
+        for ctx, run in runs(sec):
+            if not run or run[0].strip() != POC_IFDEF:
+                continue
+            m = STRUCT_RE.match(ctx)
+            if m:
+                fields.setdefault(m.group(1), []).extend(run)
+            elif path == 'kernel/sched/sched.h':
+                sched_h.extend(run)
+
+    if not found_selector:
+        sys.exit('%s: kernel/sched/poc_selector.c not found' % patch)
+
+    for name, body in fields.items():
+        with open(os.path.join(outdir, 'poc_fields_%s.h' % name), 'w') as f:
+            f.write('/* generated by extract.py - do not edit */\n')
+            f.write('\n'.join(body) + '\n')
+    with open(os.path.join(outdir, 'poc_sched.h'), 'w') as f:
+        f.write('/* generated by extract.py - do not edit */\n')
+        f.write('\n'.join(sched_h) + '\n')
+
+
+if __name__ == '__main__':
+    main()
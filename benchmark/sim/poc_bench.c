@@ -0,0 +1,874 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * poc_bench.c - Userspace replay harness for the POC selector.
+ *
+ * Builds a synthetic topology, drives the real poc_selector.c (see
+ * poc_unit.c) with a synthetic or recorded stream of idle transitions
+ * and wakeups, and reports per topology:
+ *
+ *   - cycles per select_idle_cpu_poc() call (get_cycles() units)
+ *   - the hit distribution across selection levels
+ *   - placement uniformity of the round-robin levels (2/3/5/6)
+ *
+ * Each topology runs in a forked child: static keys and initcalls are
+ * process-global in the shim, exactly as they are boot-global in the
+ * kernel.
+ *
+ * Usage: poc_bench [options]   (poc_bench -h for the list)
+ */
+#include <getopt.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "topo.h"
+#include "poc_unit.h"
+
+int poc_shim_sysctl_write(const char *name, unsigned int val);
+ssize_t poc_shim_sysfs_read(const char *group, const char *name, char *buf);
+
+/* ---- topologies ---- */
+
+static const struct poc_topo presets[] = {
+	/* name          llc  cpus smt stride          cls base node */
+	{ "zen-ccd",       2,  16, 2, 0,              0, 0, 0 },
+	{ "xeon-stride",   1,  32, 2, 16,             0, 0, 0 },
+	{ "exotic",        1,  32, 2, POC_TOPO_MIXED, 0, 0, 0 },
+	{ "power-smt4",    1,  32, 4, 0,              0, 0, 0 },
+	{ "smt-cls8",      1,  32, 2, 0,              8, 0, 0 },
+	{ "arm-cls4",      1,  16, 1, 0,              4, 0, 0 },
+	{ "flat-64",       1,  64, 1, 0,              0, 0, 0 },
+	{ "tr-unaligned",  2,  24, 2, 0,              0, 8, 0 },
+	{ "wide-128",      1, 128, 2, 0,              0, 0, 0 },
+};
+
+/* "NAME" or "LLC:CPUS:SMT:STRIDE:CLUSTER:BASE" (STRIDE -1 = mixed) */
+static int parse_topo(const char *s, struct poc_topo *t)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(presets); i++) {
+		if (!strcmp(s, presets[i].name)) {
+			*t = presets[i];
+			return 0;
+		}
+	}
+	memset(t, 0, sizeof(*t));
+	t->name = s;
+	if (sscanf(s, "%d:%d:%d:%d:%d:%d", &t->nr_llc, &t->llc_cpus, &t->smt,
+		   &t->smt_stride, &t->cluster, &t->base) < 3)
+		return -EINVAL;
+	return 0;
+}
+
+/* ---- options ---- */
+
+#define MAX_TOPOS	32
+#define MAX_KNOBS	32
+
+static struct {
+	struct poc_topo topo[MAX_TOPOS];
+	int nr_topos;
+	struct { const char *name; unsigned int val; } knob[MAX_KNOBS];
+	int nr_knobs;
+	unsigned long wakeups;
+	int util;		/* % of CPUs kept busy */
+	int sync;		/* % of wakeups with sync set */
+	int burst;		/* consecutive wakeups per waker */
+	unsigned int seed;
+	const char *trace;
+	bool micro;
+} opt = {
+	.wakeups = 1000000,
+	.util = 50,
+	.burst = 1,
+	.seed = 1,
+};
+
+/* ---- timing ---- */
+
+static inline u64 bench_cycles(void)
+{
+#if defined(__x86_64__)
+	__builtin_ia32_lfence();
+#endif
+	return get_cycles();
+}
+
+/* Cost of an empty bench_cycles() pair, subtracted from each sample */
+static u64 timer_overhead(void)
+{
+	u64 best = ~0ULL;
+	int i;
+
+	for (i = 0; i < 10000; i++) {
+		u64 t0 = bench_cycles();
+		u64 t1 = bench_cycles();
+
+		if (t1 - t0 < best)
+			best = t1 - t0;
+	}
+	return best;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	u32 x = *(const u32 *)a, y = *(const u32 *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* ---- statistics ---- */
+
+/* Modelled idle state of a CPU; see set_cpu_depth() */
+enum { BENCH_BUSY, BENCH_POLL, BENCH_C1, BENCH_C6 };
+
+struct bench_stats {
+	u32 *cyc;			/* one sample per selection */
+	unsigned long nr;
+	unsigned long ret_sat, ret_gate;	/* -1 / -2 returns */
+	unsigned long deep_picks;	/* selections that woke a CPU in C6 */
+	unsigned long ipi_picks;	/* selections that woke a non-polling CPU */
+	unsigned long busy_picks;	/* selections of a CPU running a task */
+	u8 depth[NR_CPUS];		/* modelled idle state, BENCH_POLL.. */
+	u64 idle_at[NR_CPUS];		/* local_clock() at idle entry */
+	unsigned long level[POC_UNIT_MAX_LEVELS];
+	unsigned long replay_match;	/* recorded trace: same CPU chosen */
+	unsigned long light_picks;	/* -1 wakeups placed by Level Q */
+	unsigned long stacked;		/* wakeups queued behind >= 2 tasks */
+	/* RR uniformity: observed picks vs. expected share per CPU */
+	unsigned long obs[NR_CPUS];
+	double exp[NR_CPUS];
+	unsigned long rr_picks;
+	unsigned long snap[NR_CPUS][POC_UNIT_MAX_LEVELS];
+};
+
+static struct bench_stats st;
+
+/*
+ * Chi-square of the RR picks against the shares rr_expect() gave the
+ * candidates on each call, divided by its degrees of freedom.  About
+ * 1.0 means as even as independent random picks; well below 1.0 means
+ * the round-robin spreads better than random; well above means bias.
+ */
+static double rr_chi2(void)
+{
+	double chi = 0;
+	int cells = 0, cpu;
+
+	for (cpu = 0; cpu < NR_CPUS; cpu++) {
+		double d;
+
+		if (st.exp[cpu] <= 0)
+			continue;
+		d = st.obs[cpu] - st.exp[cpu];
+		chi += d * d / st.exp[cpu];
+		cells++;
+	}
+	return cells > 1 ? chi / (cells - 1) : 0;
+}
+
+/* One /sys/kernel/poc_selector/quality/ counter, 0 if unreadable */
+static unsigned long quality_read(const char *name)
+{
+	char buf[4096];
+
+	if (poc_shim_sysfs_read("quality", name, buf) <= 0)
+		return 0;
+	return strtoul(buf, NULL, 10);
+}
+
+/*
+ * The kernel's own placement check (-o sched_poc_quality=1), against
+ * the idle_cpu() state the harness keeps in each rq.  Prints nothing
+ * while the sysctl is off.
+ */
+static void report_quality(void)
+{
+	unsigned long sel = quality_read("select");
+	unsigned long fb = quality_read("fallback");
+
+	if (!sel && !fb)
+		return;
+	printf("  quality    stale %lu  collide %lu  smt_busy %lu  missed %lu"
+	       "  (of %lu picks, %lu -1)\n",
+	       quality_read("stale"), quality_read("collide"),
+	       quality_read("smt_busy"), quality_read("missed"), sel, fb);
+}
+
+/*
+ * rr_expect - Add one call's expected pick distribution over @cand
+ * @base: @cand's poc_cpu_base
+ * @packed: poc_unit_packed(): a random 5-bit rotation followed by TZCNT
+ *
+ * RR picks uniformly.  The packed search lands on the first candidate
+ * at or after the rotation point, so each candidate's share is the
+ * run of non-candidate bits ahead of it, plus itself, out of 32.
+ */
+static void rr_expect(int base, u64 cand, bool packed)
+{
+	u64 m = cand;
+	int prev = 63 - __builtin_clzll(cand) - 32;
+
+	while (m) {
+		int bit = __builtin_ctzll(m);
+
+		if (packed) {
+			st.exp[base + bit] += (bit - prev) / 32.0;
+			prev = bit;
+		} else {
+			st.exp[base + bit] += 1.0 / __builtin_popcountll(cand);
+		}
+		m &= m - 1;
+	}
+}
+
+/*
+ * select_one - Time one selection and account its outcome
+ * @waker: CPU the wakeup runs on (poc_shim_this_cpu)
+ *
+ * Returns the selected CPU, or -1/-2 as select_idle_cpu_poc().
+ */
+static int select_one(const struct poc_topo_state *ts, int waker, int target,
+		      int prev, int recent, int sync)
+{
+	struct sched_domain_shared *sds = ts->sds[poc_topo_llc_of(ts, target)];
+	struct poc_unit_snap snap;
+	u64 t0, t1;
+	int cpu, lv;
+
+	poc_shim_this_cpu = waker;
+	poc_unit_snapshot(sds, cpu_online_mask, &snap);
+
+	t0 = bench_cycles();
+	cpu = poc_unit_select(target, prev, recent, sync, sds, cpu_online_mask);
+	t1 = bench_cycles();
+
+	st.cyc[st.nr++] = (u32)(t1 - t0);
+	if (cpu == -1)
+		st.ret_sat++;
+	else if (cpu == -2)
+		st.ret_gate++;
+	else {
+		st.deep_picks += st.depth[cpu] == BENCH_C6;
+		st.ipi_picks += st.depth[cpu] != BENCH_POLL;
+		st.busy_picks += cpu_rq(cpu)->nr_running > 0;
+	}
+
+	lv = poc_unit_level(waker, st.snap[waker]);
+	if (lv >= 0 && cpu >= 0) {
+		int base = sds->poc_cpu_base;
+		u64 cand = poc_unit_candidates(lv, target, &snap, sds);
+
+		st.level[lv]++;
+		/* A pick outside @cand: the bitmap moved under the snapshot */
+		if (hweight64(cand) > 1 && (unsigned int)(cpu - base) < 64 &&
+		    (cand & (1ULL << (cpu - base)))) {
+			rr_expect(base, cand, poc_unit_packed(sds));
+			st.obs[cpu]++;
+			st.rr_picks++;
+		}
+	}
+	return cpu;
+}
+
+/* do_idle() transition on @cpu; a busy CPU runs a non-idle task */
+static struct task_struct bench_running = { .pid = 1, .active_mm = &init_mm };
+
+/*
+ * cpuidle model: a CPU polls on idle entry, drops to a C1-class state
+ * once it has been idle for BENCH_C1_AFTER_NS and to a C6-class one
+ * after BENCH_C6_AFTER_NS, as a governor does once its sleep-length
+ * prediction has been beaten.
+ */
+#define BENCH_C1_EXIT_NS	1000
+#define BENCH_C6_EXIT_NS	100000
+#define BENCH_C1_AFTER_NS	8000
+#define BENCH_C6_AFTER_NS	32000
+
+static void set_cpu_depth(int cpu, int depth)
+{
+	static const u64 exit_ns[] = {
+		[BENCH_POLL] = 0,
+		[BENCH_C1] = BENCH_C1_EXIT_NS,
+		[BENCH_C6] = BENCH_C6_EXIT_NS,
+	};
+
+	st.depth[cpu] = depth;
+	poc_shim_this_cpu = cpu;
+	poc_unit_idle_state(cpu, exit_ns[depth], depth == BENCH_POLL);
+}
+
+static void set_cpu_state(int cpu, int state)
+{
+	cpu_rq(cpu)->curr = state ? cpu_rq(cpu)->idle : &bench_running;
+	poc_shim_this_cpu = cpu;
+	__set_cpu_idle_state_poc(cpu, state);
+	st.idle_at[cpu] = poc_shim_clock_ns;
+	if (state)
+		set_cpu_depth(cpu, BENCH_POLL);
+	else
+		st.depth[cpu] = BENCH_BUSY;
+}
+
+/*
+ * SIS_UTIL: update_idle_cpu_scan() with each busy CPU at full
+ * capacity and the LLC's imbalance_pct of 117, so nr_idle_scan drops
+ * to 0 above about 85% occupancy.
+ */
+static void update_idle_scan(const struct poc_topo_state *ts, const bool *busy)
+{
+	int l, cpu;
+
+	for (l = 0; l < ts->nr_llc; l++) {
+		int first = ts->llc_first[l];
+		int last = l + 1 < ts->nr_llc ? ts->llc_first[l + 1] : ts->nr_cpus;
+		int weight = last - first, nr_busy = 0;
+		u64 x, y;
+
+		for (cpu = first; cpu < last; cpu++)
+			nr_busy += busy[cpu];
+		x = (u64)nr_busy * SCHED_CAPACITY_SCALE / weight;
+		x = x * x * 117 * 117 / (10000 * SCHED_CAPACITY_SCALE);
+		y = x < SCHED_CAPACITY_SCALE ? SCHED_CAPACITY_SCALE - x : 0;
+		WRITE_ONCE(ts->sds[l]->nr_idle_scan, y * weight / SCHED_CAPACITY_SCALE);
+	}
+}
+
+/* ---- synthetic workload ---- */
+
+/*
+ * Tasks sleep and wake at random.  Every other wakeup runs on a busy
+ * CPU (task-to-task), the rest on any CPU (timer or IRQ).  The waker
+ * is the target, except that for a cross-LLC wakee wake_affine() is
+ * modelled as a coin flip between the waker and the task's last CPU.
+ * prev and recent are passed as select_idle_sibling() does.  The
+ * chosen CPU turns busy; tasks then finish on random busy CPUs so the
+ * runnable count stays at -u percent of the CPUs.  Above 100 the LLC
+ * is saturated: POC returns -1, and the wakee goes where Level Q
+ * (sched_poc_stack_avoid) puts it, or onto target.  With -b N, each
+ * waker issues N wakeups in a row (fan-out).  local_clock() advances 1us per wakeup, and every
+ * 1000 wakeups each busy CPU takes a scheduler tick and nr_idle_scan
+ * is recomputed.
+ */
+struct bench_task {
+	int prev, recent;
+};
+
+/* add_nr_running() / sub_nr_running() by one task on @cpu */
+static void cpu_queue(int cpu, int change)
+{
+	poc_unit_nr_running(cpu, cpu_rq(cpu)->nr_running + change);
+}
+
+static void run_synthetic(const struct poc_topo *t, const struct poc_topo_state *ts)
+{
+	int first = t->base, nr = ts->nr_cpus - t->base;
+	int nr_tasks = nr * 2, want_run = nr * opt.util / 100;
+	int want_busy = want_run < nr ? want_run : nr;
+	struct bench_task *task = calloc(nr_tasks, sizeof(*task));
+	bool *busy = calloc(NR_CPUS, sizeof(bool));
+	int nr_busy = 0, nr_run, waker = first, cpu, i;
+	unsigned long w;
+
+	srand(opt.seed);
+	for (i = 0; i < nr_tasks; i++) {
+		task[i].prev = first + rand() % nr;
+		task[i].recent = task[i].prev;
+	}
+	for (cpu = first; cpu < ts->nr_cpus; cpu++) {
+		set_cpu_state(cpu, 1);
+	}
+	while (nr_busy < want_busy) {
+		cpu = first + rand() % nr;
+		if (busy[cpu])
+			continue;
+		busy[cpu] = true;
+		nr_busy++;
+		cpu_queue(cpu, 1);
+		set_cpu_state(cpu, 0);
+	}
+	for (nr_run = nr_busy; nr_run < want_run; nr_run++)
+		cpu_queue(first + rand() % nr, 1);
+	update_idle_scan(ts, busy);
+
+	for (w = 0; w < opt.wakeups; w++) {
+		struct bench_task *p = &task[rand() % nr_tasks];
+		int target, recent, sel;
+
+		poc_shim_clock_ns += 1000;
+		if (w && !(w % 1000)) {
+			for (cpu = first; cpu < ts->nr_cpus; cpu++) {
+				if (!busy[cpu])
+					continue;
+				poc_shim_this_cpu = cpu;
+				poc_unit_idle_tick(cpu);
+			}
+			update_idle_scan(ts, busy);
+		}
+		if (!(w % 4)) {
+			for (cpu = first; cpu < ts->nr_cpus; cpu++) {
+				u64 idle_ns = poc_shim_clock_ns - st.idle_at[cpu];
+				int depth = idle_ns >= BENCH_C6_AFTER_NS ? BENCH_C6 :
+					    idle_ns >= BENCH_C1_AFTER_NS ? BENCH_C1 :
+					    BENCH_POLL;
+
+				if (!busy[cpu] && depth > st.depth[cpu])
+					set_cpu_depth(cpu, depth);
+			}
+		}
+		/* Half task-to-task wakeups (busy waker), half timer/IRQ (any) */
+		if (w % opt.burst == 0) {
+			do
+				waker = first + rand() % nr;
+			while (((w / opt.burst) & 1) && nr_busy && !busy[waker]);
+		}
+		/* wake_affine(): half the cross-LLC wakeups stay on prev's side */
+		target = waker;
+		if (poc_topo_llc_of(ts, p->prev) != poc_topo_llc_of(ts, waker) &&
+		    rand() & 1)
+			target = p->prev;
+
+		/* select_idle_sibling()'s recent_used_cpu filter */
+		recent = p->recent;
+		p->recent = p->prev;
+		if (recent == p->prev || recent == target ||
+		    poc_topo_llc_of(ts, recent) != poc_topo_llc_of(ts, target))
+			recent = -1;
+
+		sel = select_one(ts, waker, target, p->prev, recent,
+				 rand() % 100 < opt.sync);
+		if (sel == -1) {
+			/* select_idle_sibling(): CFS finds nothing either */
+			poc_shim_this_cpu = waker;
+			sel = poc_unit_select_light(target, p->prev,
+						    cpu_online_mask);
+			if (sel >= 0)
+				st.light_picks++;
+			else
+				sel = target;
+		}
+		if (sel < 0)
+			continue;
+		poc_shim_this_cpu = waker;
+		poc_unit_placed(sel);
+		p->prev = sel;
+		st.stacked += cpu_rq(sel)->nr_running >= 2;
+		cpu_queue(sel, 1);
+		nr_run++;
+		if (!busy[sel]) {
+			busy[sel] = true;
+			nr_busy++;
+		}
+		set_cpu_state(sel, 0);
+
+		while (nr_run > want_run) {
+			cpu = first + rand() % nr;
+			if (!busy[cpu])
+				continue;
+			cpu_queue(cpu, -1);
+			nr_run--;
+			if (cpu_rq(cpu)->nr_running)
+				continue;
+			busy[cpu] = false;
+			nr_busy--;
+			set_cpu_state(cpu, 1);
+		}
+	}
+	for (cpu = first; cpu < ts->nr_cpus; cpu++)
+		poc_unit_nr_running(cpu, 0);
+	free(task);
+	free(busy);
+}
+
+/* ---- recorded trace replay ---- */
+
+/*
+ * Input is ftrace text output (trace_pipe, "perf script", trace-cmd
+ * report) with sched:sched_poc_idle_state and sched:sched_poc_select
+ * enabled.  Idle transitions are applied as recorded; each select is
+ * re-run on the recorded waker CPU (the "[NNN]" field) and compared
+ * against the recorded choice.  sync is not recorded and replays as 0.
+ */
+static int trace_field(const char *line, const char *key, long *val)
+{
+	const char *p = strstr(line, key);
+
+	if (!p)
+		return -1;
+	*val = strtol(p + strlen(key), NULL, 0);
+	return 0;
+}
+
+static int trace_waker(const char *line)
+{
+	const char *p = strchr(line, '[');
+
+	return p ? atoi(p + 1) : -1;
+}
+
+static int run_trace(const struct poc_topo_state *ts)
+{
+	bool seen[NR_CPUS] = { false };
+	FILE *f = fopen(opt.trace, "r");
+	char line[1024];
+	long cpu, state;
+	int c;
+
+	if (!f) {
+		perror(opt.trace);
+		return -1;
+	}
+
+	/* CPUs whose first event leaves idle were idle when recording began */
+	for (c = 0; c < ts->nr_cpus; c++) {
+		set_cpu_state(c, 0);
+	}
+	while (fgets(line, sizeof(line), f)) {
+		if (!strstr(line, "sched_poc_idle_state:") ||
+		    trace_field(line, "cpu=", &cpu) ||
+		    trace_field(line, "state=", &state) ||
+		    cpu < 0 || cpu >= ts->nr_cpus || seen[cpu])
+			continue;
+		seen[cpu] = true;
+		if (!state) {
+			set_cpu_state(cpu, 1);
+		}
+	}
+
+	rewind(f);
+	while (fgets(line, sizeof(line), f)) {
+		if (strstr(line, "sched_poc_idle_state:")) {
+			if (trace_field(line, "cpu=", &cpu) ||
+			    trace_field(line, "state=", &state) ||
+			    cpu < 0 || cpu >= ts->nr_cpus)
+				continue;
+			set_cpu_state(cpu, state);
+		} else if (strstr(line, "sched_poc_select:")) {
+			long target, prev, recent, rec_cpu;
+			int waker = trace_waker(line);
+
+			if (trace_field(line, "target=", &target) ||
+			    trace_field(line, "prev=", &prev) ||
+			    trace_field(line, "recent=", &recent) ||
+			    trace_field(line, " cpu=", &rec_cpu) ||
+			    target < 0 || target >= ts->nr_cpus ||
+			    prev < 0 || prev >= ts->nr_cpus ||
+			    poc_topo_llc_of(ts, target) < 0)
+				continue;
+			if (waker < 0 || waker >= ts->nr_cpus)
+				waker = target;
+			if (st.nr >= opt.wakeups)
+				break;
+			if (select_one(ts, waker, target, prev, recent, 0) == rec_cpu)
+				st.replay_match++;
+		}
+	}
+	fclose(f);
+	return 0;
+}
+
+/* ---- helper micro-benchmarks ---- */
+
+static void run_micro(const struct poc_topo_state *ts)
+{
+	static const char *const names[POC_MICRO_NR] = {
+		[POC_MICRO_RR]		= "poc_select_rr",
+		[POC_MICRO_PTSELECT]	= "POC_PTSELECT",
+		[POC_MICRO_BMP8]	= "poc_flags_to_u64",
+		[POC_MICRO_CORE_MASK]	= "poc_idle_core_mask",
+		[POC_MICRO_MM_MATCH]	= "poc_mm_match",
+	};
+	enum { N = 4096 };
+	static u64 masks[N];
+	u64 members = ts->sds[0]->poc_llc_members;
+	unsigned long iters = 1UL << 22;
+	int i, which;
+
+	srand(opt.seed);
+	for (i = 0; i < N; i++) {
+		u64 m = (((u64)rand() << 33) ^ ((u64)rand() << 11) ^ rand()) & members;
+
+		masks[i] = m ? m : 1;
+	}
+	for (which = 0; which < POC_MICRO_NR; which++) {
+		u64 t0, t1, sum;
+
+		if (which == POC_MICRO_CORE_MASK && !poc_shim_smt_active)
+			continue;
+		t0 = bench_cycles();
+		sum = poc_unit_micro(which, masks, N, iters, ts->sds[0]);
+		t1 = bench_cycles();
+		printf("  %-20s %6.2f cyc/call  (sum %016" PRIx64 ")\n",
+		       names[which], (double)(t1 - t0) / iters, sum);
+	}
+}
+
+/*
+ * nohz idle-balancer kick: find_new_ilb()'s walk of
+ * nohz.idle_cpus_mask against poc_find_new_ilb() (walk on -1), for a
+ * random busy kicker at -u percent of the CPUs busy.  "local" is the
+ * share of kicks whose balancer shares the kicker's LLC.  The harness
+ * is single-threaded, so the walk's remote rq misses are not in the
+ * cycle counts.
+ */
+static int ilb_walk(const struct cpumask *idle_mask, int this_cpu)
+{
+	int cpu;
+
+	for_each_cpu(cpu, idle_mask) {
+		if (cpu == this_cpu)
+			continue;
+		if (idle_cpu(cpu))
+			return cpu;
+	}
+	return -1;
+}
+
+static void run_ilb(const struct poc_topo *t, const struct poc_topo_state *ts)
+{
+	enum { ROUNDS = 256, KICKS = 64 };
+	int first = t->base, nr = ts->nr_cpus - t->base;
+	unsigned long calls = 0, local[2] = { 0 }, found[2] = { 0 };
+	u64 cyc[2] = { 0 }, overhead = timer_overhead();
+	struct cpumask idle_mask;
+	int r, k, cpu, v;
+
+	srand(opt.seed);
+	for (r = 0; r < ROUNDS; r++) {
+		cpumask_clear(&idle_mask);
+		for (cpu = first; cpu < ts->nr_cpus; cpu++) {
+			bool idle = rand() % 100 >= opt.util;
+
+			set_cpu_state(cpu, idle);
+			if (idle)
+				cpumask_set_cpu(cpu, &idle_mask);
+		}
+		for (k = 0; k < KICKS; k++) {
+			int kicker = first + rand() % nr;
+
+			if (cpumask_test_cpu(kicker, &idle_mask))
+				continue;
+			poc_shim_this_cpu = kicker;
+			calls++;
+			for (v = 0; v < 2; v++) {
+				u64 t0 = bench_cycles(), t1;
+
+				cpu = v ? poc_unit_ilb(&idle_mask, cpu_online_mask) : -1;
+				if (cpu < 0)
+					cpu = ilb_walk(&idle_mask, kicker);
+				t1 = bench_cycles();
+				cyc[v] += t1 - t0 > overhead ? t1 - t0 - overhead : 0;
+				if (cpu < 0)
+					continue;
+				found[v]++;
+				local[v] += poc_topo_llc_of(ts, cpu) ==
+					    poc_topo_llc_of(ts, kicker);
+			}
+		}
+	}
+	for (v = 0; v < 2; v++)
+		printf("  %-20s %6.2f cyc/call  local %5.1f%%\n",
+		       v ? "ilb poc" : "ilb walk",
+		       calls ? (double)cyc[v] / calls : 0.0,
+		       found[v] ? 100.0 * local[v] / found[v] : 0.0);
+}
+
+/* ---- per-topology driver ---- */
+
+static void report(const struct poc_topo *t, const char *desc, u64 overhead)
+{
+	unsigned long i, n = st.nr, hits = 0;
+	double mean = 0;
+	int lv;
+
+	for (i = 0; i < n; i++) {
+		st.cyc[i] = st.cyc[i] > overhead ? st.cyc[i] - overhead : 0;
+		mean += st.cyc[i];
+	}
+	qsort(st.cyc, n, sizeof(*st.cyc), cmp_u32);
+
+	printf("%s: %s\n", t->name, desc);
+	if (!n) {
+		printf("  no selections\n");
+		return;
+	}
+	printf("  selections %lu  cyc/sel mean %.1f p50 %u p99 %u p99.9 %u\n",
+	       n, mean / n, st.cyc[n / 2], st.cyc[n * 99 / 100],
+	       st.cyc[n * 999 / 1000]);
+	printf("  returns    -1 %.2f%%  -2 %.2f%%",
+	       100.0 * st.ret_sat / n, 100.0 * st.ret_gate / n);
+	if (opt.trace)
+		printf("  replay-match %.2f%%", 100.0 * st.replay_match / n);
+	else
+		printf("  deep %.2f%%  ipi %.2f%%", 100.0 * st.deep_picks / n,
+		       100.0 * st.ipi_picks / n);
+	if (st.busy_picks)
+		printf("  onbusy %.3f%%", 100.0 * st.busy_picks / n);
+	if (opt.util > 100)
+		printf("  lq %.2f%%  stacked %.2f%%", 100.0 * st.light_picks / n,
+		       100.0 * st.stacked / n);
+	printf("\n  levels    ");
+	for (lv = 0; lv < poc_unit_nr_levels(); lv++) {
+		if (!st.level[lv])
+			continue;
+		hits++;
+		printf(" %s %.1f%%", poc_unit_level_name(lv),
+		       100.0 * st.level[lv] / n);
+	}
+	if (!hits)
+		printf(" (none)");
+	printf("\n  rr spread  picks %lu  chi2/dof %.3f\n",
+	       st.rr_picks, rr_chi2());
+	report_quality();
+}
+
+static int run_topo(const struct poc_topo *t)
+{
+	struct poc_topo_state ts;
+	char desc[160];
+	u64 overhead;
+	int i, ret;
+
+	ret = poc_topo_build(t, &ts);
+	if (ret) {
+		fprintf(stderr, "%s: invalid topology (%d)\n", t->name, ret);
+		return 1;
+	}
+
+	/* Level 1r/1t stay inside POC unless the user opts back in */
+	poc_shim_sysctl_write("sched_poc_early_select", 0);
+	poc_shim_sysctl_write("sched_poc_count", 1);
+	for (i = 0; i < opt.nr_knobs; i++) {
+		if (poc_shim_sysctl_write(opt.knob[i].name, opt.knob[i].val)) {
+			fprintf(stderr, "%s: cannot set %s\n", t->name,
+				opt.knob[i].name);
+			return 1;
+		}
+	}
+
+	poc_unit_describe(desc, sizeof(desc));
+	if (opt.micro) {
+		printf("%s: %s\n", t->name, desc);
+		run_micro(&ts);
+		run_ilb(t, &ts);
+		return 0;
+	}
+
+	st.cyc = calloc(opt.wakeups, sizeof(*st.cyc));
+	if (!st.cyc)
+		return 1;
+	overhead = timer_overhead();
+	if (opt.trace)
+		ret = run_trace(&ts);
+	else
+		run_synthetic(t, &ts);
+	if (!ret)
+		report(t, desc, overhead);
+	return ret ? 1 : 0;
+}
+
+static void usage(const char *prog)
+{
+	size_t i;
+
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"  -t TOPO        topology preset or LLC:CPUS:SMT:STRIDE:CLUSTER:BASE\n"
+		"                 (STRIDE -1 = mixed layout); repeatable, default all presets\n"
+		"  -o NAME=VAL    write kernel.NAME before the run (e.g. sched_poc_rr_improved=0)\n"
+		"  -n N           wakeups to simulate (default %lu)\n"
+		"  -u PCT         runnable tasks as %% of CPUs, synthetic load, 0-200 (default %d)\n"
+		"  -y PCT         share of sync wakeups (default %d)\n"
+		"  -b N           wakeups per waker in a row, synthetic load (default 1)\n"
+		"  -s SEED        random seed (default %u)\n"
+		"  -r FILE        replay a recorded sched_poc_* ftrace text file\n"
+		"  -m             time the selection helpers instead\n"
+		"presets:",
+		prog, opt.wakeups, opt.util, opt.sync, opt.seed);
+	for (i = 0; i < ARRAY_SIZE(presets); i++)
+		fprintf(stderr, " %s", presets[i].name);
+	fprintf(stderr, "\n");
+	exit(2);
+}
+
+int main(int argc, char **argv)
+{
+	int c, i, fail = 0;
+
+	while ((c = getopt(argc, argv, "t:o:n:u:y:b:s:r:mh")) != -1) {
+		switch (c) {
+		case 't':
+			if (opt.nr_topos == MAX_TOPOS ||
+			    parse_topo(optarg, &opt.topo[opt.nr_topos]))
+				usage(argv[0]);
+			opt.nr_topos++;
+			break;
+		case 'o': {
+			char *eq = strchr(optarg, '=');
+
+			if (!eq || opt.nr_knobs == MAX_KNOBS)
+				usage(argv[0]);
+			*eq = '\0';
+			opt.knob[opt.nr_knobs].name = optarg;
+			opt.knob[opt.nr_knobs].val = strtoul(eq + 1, NULL, 0);
+			opt.nr_knobs++;
+			break;
+		}
+		case 'n':
+			opt.wakeups = strtoul(optarg, NULL, 0);
+			break;
+		case 'u':
+			opt.util = atoi(optarg);
+			break;
+		case 'y':
+			opt.sync = atoi(optarg);
+			break;
+		case 'b':
+			opt.burst = atoi(optarg);
+			break;
+		case 's':
+			opt.seed = strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			opt.trace = optarg;
+			break;
+		case 'm':
+			opt.micro = true;
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (opt.util < 0 || opt.util > 200 || !opt.wakeups || opt.burst < 1)
+		usage(argv[0]);
+	if (opt.trace && opt.nr_topos != 1) {
+		fprintf(stderr, "-r needs exactly one -t describing the traced machine\n");
+		return 2;
+	}
+	if (!opt.nr_topos) {
+		for (i = 0; i < (int)ARRAY_SIZE(presets); i++)
+			opt.topo[i] = presets[i];
+		opt.nr_topos = ARRAY_SIZE(presets);
+	}
+
+	for (i = 0; i < opt.nr_topos; i++) {
+		pid_t pid;
+		int status;
+
+		fflush(stdout);
+		pid = fork();
+		if (pid < 0) {
+			perror("fork");
+			return 1;
+		}
+		if (!pid)
+			exit(run_topo(&opt.topo[i]));
+		if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+		    WEXITSTATUS(status))
+			fail = 1;
+	}
+	return fail;
+}
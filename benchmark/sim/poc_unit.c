@@ -0,0 +1,277 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * poc_unit.c - Translation unit that builds poc_selector.c against the
+ * userspace shim, mirroring how fair.c #includes it in the kernel.
+ *
+ * Everything in poc_selector.c is static; the poc_unit_*() wrappers
+ * below are the only way in for the harness.
+ */
+#include "kernel_shim.h"
+
+DEFINE_PER_CPU(struct sched_domain_shared *, sd_llc_shared);
+DEFINE_PER_CPU(int, sd_llc_id);
+DEFINE_PER_CPU(int, sd_llc_size);
+
+#include "poc_sched.h"
+#include "poc_selector.c"
+
+#include "poc_unit.h"
+
+int poc_unit_select(int target, int prev, int recent, int sync,
+		    struct sched_domain_shared *sd_share,
+		    const struct cpumask *allowed)
+{
+	return select_idle_cpu_poc(target, prev, recent, sync,
+				   sd_share, allowed, 0, POC_POLICY_CORE);
+}
+
+int poc_unit_select_mm(int target, int prev, int recent, int sync,
+		       struct sched_domain_shared *sd_share,
+		       const struct cpumask *allowed, struct task_struct *p)
+{
+	return select_idle_cpu_poc(target, prev, recent, sync,
+				   sd_share, allowed, poc_task_mm_tag(p),
+				   poc_task_policy(p));
+}
+
+int poc_unit_select_xllc(struct task_struct *p, int target, int prev,
+			 int sync, struct sched_domain_shared *sd_share)
+{
+	return select_idle_cpu_poc_xllc(p, target, prev, sync, sd_share);
+}
+
+int poc_unit_select_light(int target, int prev, const struct cpumask *allowed)
+{
+	return select_light_cpu_poc(target, prev, allowed);
+}
+
+void poc_unit_nr_running(int cpu, unsigned int nr_running)
+{
+	cpu_rq(cpu)->nr_running = nr_running;
+}
+
+#ifdef CONFIG_NO_HZ_COMMON
+int poc_unit_ilb(const struct cpumask *idle_mask, const struct cpumask *hk_mask)
+{
+	return poc_find_new_ilb(idle_mask, hk_mask);
+}
+#endif
+
+void poc_unit_idle_tick(int cpu)
+{
+	poc_idle_tick(cpu_rq(cpu));
+}
+
+void poc_unit_placed(int cpu)
+{
+	poc_idle_placed(cpu);
+}
+
+void poc_unit_idle_state(int cpu, u64 exit_latency_ns, bool polling)
+{
+	poc_note_idle_state(cpu, exit_latency_ns, polling);
+}
+
+void poc_unit_reset_rr(void)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		per_cpu(poc_rr_counter, cpu) = 0;
+}
+
+int poc_unit_select_asym(struct task_struct *p, struct sched_domain *sd,
+			 int target, int prev)
+{
+	return select_idle_cpu_poc_asym(p, sd, target, prev);
+}
+
+/* ---- level accounting ---- */
+
+/* Same names and order as /sys/kernel/poc_selector/count/ */
+static const char *const poc_unit_level_names[POC_NR_LEVELS] = {
+	[POC_LV1S] = "l1s",	[POC_LV1T] = "l1t",	[POC_LV1P] = "l1p",
+	[POC_LV1R] = "l1r",	[POC_LV2] = "l2",	[POC_LV3] = "l3",
+	[POC_LV4S] = "l4s",	[POC_LV4P] = "l4p",	[POC_LV4R] = "l4r",
+	[POC_LV4T] = "l4t",	[POC_LV5] = "l5",	[POC_LV6] = "l6",
+	[POC_LV7] = "l7",	[POC_LVA] = "la",	[POC_LVH] = "lh",
+	[POC_LVB] = "lb",	[POC_LVQ] = "lq",	[POC_FALLBACK] = "fallback",
+};
+
+int poc_unit_nr_levels(void)
+{
+	return POC_NR_LEVELS;
+}
+
+const char *poc_unit_level_name(int lv)
+{
+	return (unsigned int)lv < POC_NR_LEVELS && poc_unit_level_names[lv] ?
+		poc_unit_level_names[lv] : "?";
+}
+
+/*
+ * poc_unit_level - Level that resolved the last selection run on @cpu
+ * @snap: caller's copy of @cpu's counters, POC_UNIT_MAX_LEVELS entries
+ *
+ * Diffs the per-CPU hit counters (sysctl sched_poc_count must be on)
+ * against @snap and folds them in.  Returns -1 if nothing was counted.
+ */
+int poc_unit_level(int cpu, unsigned long *snap)
+{
+	unsigned long *cnt = per_cpu(poc_debug_cnt, cpu);
+	int lv, hit = -1;
+
+	for (lv = 0; lv < POC_NR_LEVELS; lv++) {
+		if (cnt[lv] != snap[lv]) {
+			hit = lv;
+			snap[lv] = cnt[lv];
+		}
+	}
+	return hit;
+}
+
+/*
+ * poc_unit_candidates - Candidate set the resolving level searched
+ * @lv: level returned by poc_unit_level()
+ * @snap: poc_unit_snapshot() taken before the call
+ *
+ * Rebuilds the mask __select_idle_cpu_poc() handed to its RR step:
+ * idle cores (SMT, Levels 2/3) or idle CPUs within the wakee's
+ * affinity, narrowed to target's cluster for Level 2/5 and then to
+ * the polling/shallow subset by poc_prefer_idle().  Level 3/6 only
+ * runs once the cluster came up empty, so it searches the whole set.
+ * Returns 0 for levels that pick a fixed CPU.
+ */
+u64 poc_unit_candidates(int lv, int target, const struct poc_unit_snap *snap,
+			struct sched_domain_shared *sd_share)
+{
+	u64 cls = 0, mask;
+
+#ifdef CONFIG_SCHED_POC_MULTIWORD
+	/* Per-word search (select_idle_cpu_poc_mw()): not modelled */
+	if (sd_share->poc_nr_words > 1)
+		return 0;
+#endif
+	if (static_branch_likely(&sched_cluster_active) &&
+	    sd_share->poc_cluster_valid)
+		cls = poc_cls_mask(target - sd_share->poc_cpu_base, sd_share);
+
+	switch (lv) {
+	case POC_LV2:
+		mask = snap->idle_cores & cls;
+		break;
+	case POC_LV3:
+		mask = snap->idle_cores;
+		break;
+	case POC_LV5:
+		mask = snap->idle_cpus & cls;
+		break;
+	case POC_LV6:
+		mask = snap->idle_cpus;
+		break;
+	default:
+		return 0;
+	}
+	return poc_prefer_idle(mask, snap->polling, snap->shallow);
+}
+
+/* Does @sd_share take the packed search (rotate + TZCNT) over RR? */
+bool poc_unit_packed(struct sched_domain_shared *sd_share)
+{
+	return static_branch_likely(&sched_poc_packed) || sd_share->poc_packed;
+}
+
+void poc_unit_snapshot(struct sched_domain_shared *sd_share,
+		       const struct cpumask *allowed, struct poc_unit_snap *snap)
+{
+	u64 affinity = poc_cpumask_to_u64(allowed, sd_share);
+
+	snap->idle_cpus = poc_idle_cpu_mask(affinity, sd_share);
+	snap->idle_cores = snap->idle_cpus;
+#ifdef CONFIG_SCHED_SMT
+	if (sched_smt_active())
+		snap->idle_cores = poc_idle_core_mask(snap->idle_cpus, sd_share);
+#endif
+	snap->polling = poc_polling_mask(sd_share);
+	snap->shallow = poc_shallow_mask(sd_share);
+}
+
+/* One-line summary of the boot-time keys derived from the topology */
+void poc_unit_describe(char *buf, size_t len)
+{
+	const char *tier = "none";
+
+#ifdef CONFIG_SCHED_SMT
+	if (sched_smt_active()) {
+		if (static_branch_likely(&sched_poc_smt_consecutive))
+			tier = "1";
+		else if (static_branch_likely(&sched_poc_smt_uniform))
+			tier = "2";
+		else if (static_branch_likely(&sched_poc_smt_grouped))
+			tier = "2n";
+		else
+			tier = "3";
+	}
+#endif
+	snprintf(buf, len, "smt-tier=%s packed=%d aligned=%d cluster=%d multiword=%d",
+		 tier,
+		 static_key_enabled(&sched_poc_packed),
+		 static_key_enabled(&sched_poc_aligned),
+		 static_key_enabled(&sched_cluster_active),
+#ifdef CONFIG_SCHED_POC_MULTIWORD
+		 static_key_enabled(&sched_poc_multiword)
+#else
+		 0
+#endif
+		 );
+}
+
+/* ---- helper micro-benchmarks ---- */
+
+/*
+ * poc_unit_micro - Run one selection helper over @masks
+ * @which: enum poc_unit_micro
+ * @masks: @n non-zero masks; @n must be a power of two >= 8
+ * @iters: number of calls
+ *
+ * The loop lives here so the helper is inlined exactly as it is on
+ * the selection path.  Returns a checksum to keep the calls alive.
+ */
+u64 poc_unit_micro(int which, const u64 *masks, unsigned int n,
+		   unsigned long iters, struct sched_domain_shared *sd_share)
+{
+	unsigned int mod = n - 1;
+	unsigned long i;
+	u64 sum = 0;
+
+	switch (which) {
+	case POC_MICRO_RR:
+		for (i = 0; i < iters; i++)
+			sum += poc_select_rr(0, masks[i & mod], (unsigned int)i);
+		break;
+	case POC_MICRO_PTSELECT:
+		for (i = 0; i < iters; i++) {
+			u64 m = masks[i & mod];
+			u32 j = POC_FASTRANGE(POC_SCRAMBLE((unsigned int)i),
+					      hweight64(m));
+
+			sum += POC_PTSELECT(m, j);
+		}
+		break;
+	case POC_MICRO_BMP8:
+		for (i = 0; i < iters; i++)
+			sum += poc_flags_to_u64((const u8 *)&masks[(i * 8) & mod & ~7UL]);
+		break;
+	case POC_MICRO_CORE_MASK:
+#ifdef CONFIG_SCHED_SMT
+		for (i = 0; i < iters; i++)
+			sum += poc_idle_core_mask(masks[i & mod], sd_share);
+#endif
+		break;
+	case POC_MICRO_MM_MATCH:
+		for (i = 0; i < iters; i++)
+			sum += poc_mm_match(sd_share, (u8)(i | 1));
+		break;
+	}
+	return sum;
+}
@@ -0,0 +1,77 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _POC_UNIT_H
+#define _POC_UNIT_H
+
+int poc_unit_select(int target, int prev, int recent, int sync,
+		    struct sched_domain_shared *sd_share,
+		    const struct cpumask *allowed);
+
+int poc_unit_select_mm(int target, int prev, int recent, int sync,
+		       struct sched_domain_shared *sd_share,
+		       const struct cpumask *allowed, struct task_struct *p);
+
+int poc_unit_select_xllc(struct task_struct *p, int target, int prev,
+			 int sync, struct sched_domain_shared *sd_share);
+
+/* select_idle_sibling()'s last step: Level Q when @target is queued */
+int poc_unit_select_light(int target, int prev, const struct cpumask *allowed);
+
+/* add_nr_running() / sub_nr_running() on @cpu, ending at @nr_running */
+void poc_unit_nr_running(int cpu, unsigned int nr_running);
+
+void poc_unit_idle_tick(int cpu);
+
+/* select_task_rq_fair() after select_idle_sibling() chose @cpu */
+void poc_unit_placed(int cpu);
+
+#ifdef CONFIG_NO_HZ_COMMON
+/* find_new_ilb()'s POC pick; -1 means "walk nohz.idle_cpus_mask" */
+int poc_unit_ilb(const struct cpumask *idle_mask, const struct cpumask *hk_mask);
+#endif
+
+/* sched_idle_set_state() on @cpu entering a state with this exit latency */
+void poc_unit_idle_state(int cpu, u64 exit_latency_ns, bool polling);
+
+void poc_unit_reset_rr(void);
+
+int poc_unit_select_asym(struct task_struct *p, struct sched_domain *sd,
+			 int target, int prev);
+
+/* Level accounting (needs sysctl sched_poc_count=1) */
+#define POC_UNIT_MAX_LEVELS	32
+
+int poc_unit_nr_levels(void);
+const char *poc_unit_level_name(int lv);
+int poc_unit_level(int cpu, unsigned long *snap);
+
+/* The masks __select_idle_cpu_poc() searches, read before the call */
+struct poc_unit_snap {
+	u64 idle_cpus;		/* idle CPUs within the wakee's affinity */
+	u64 idle_cores;		/* idle cores of those (== idle_cpus w/o SMT) */
+	u64 polling;		/* poc_polling_mask() */
+	u64 shallow;		/* poc_shallow_mask() */
+};
+
+u64 poc_unit_candidates(int lv, int target, const struct poc_unit_snap *snap,
+			struct sched_domain_shared *sd_share);
+bool poc_unit_packed(struct sched_domain_shared *sd_share);
+void poc_unit_snapshot(struct sched_domain_shared *sd_share,
+		       const struct cpumask *allowed, struct poc_unit_snap *snap);
+void poc_unit_describe(char *buf, size_t len);
+
+enum poc_unit_micro {
+	POC_MICRO_RR,		/* poc_select_rr() (per sched_poc_rr_improved) */
+	POC_MICRO_PTSELECT,	/* POC_PTSELECT() */
+	POC_MICRO_BMP8,		/* poc_flags_to_u64() (POC_BMP8 x 8) */
+	POC_MICRO_CORE_MASK,	/* poc_idle_core_mask() (SMT tier in use) */
+	POC_MICRO_MM_MATCH,	/* poc_mm_match() */
+	POC_MICRO_NR
+};
+
+u64 poc_unit_micro(int which, const u64 *masks, unsigned int n,
+		   unsigned long iters, struct sched_domain_shared *sd_share);
+
+/* Entry points exported by poc_selector.c itself */
+void __set_cpu_idle_state_poc(int cpu, int state);
+
+#endif
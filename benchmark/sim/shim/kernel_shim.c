@@ -0,0 +1,319 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * kernel_shim.c - Backing storage and stub implementations for
+ * kernel_shim.h.  See that header for the overall model.
+ */
+#include <stdarg.h>
+#include <stdlib.h>
+
+#include "kernel_shim.h"
+
+__thread int poc_shim_this_cpu;
+char *poc_shim_pcpu_area[NR_CPUS];
+
+unsigned int nr_cpu_ids = NR_CPUS;
+struct cpumask poc_shim_online_mask;
+struct cpumask poc_shim_isolated_mask;
+struct cpumask poc_shim_smt_mask[NR_CPUS];
+struct cpumask poc_shim_cluster_mask[NR_CPUS];
+int poc_shim_cpu_node[NR_CPUS];
+unsigned long poc_shim_cpu_capacity[NR_CPUS];
+bool poc_shim_smt_active;
+bool poc_shim_asym_active;
+bool poc_shim_sched_feat[1] = { true };
+
+struct rq poc_shim_rqs[NR_CPUS];
+DEFINE_STATIC_KEY_FALSE(sched_cluster_active);
+
+unsigned int poc_shim_zero, poc_shim_one = 1;
+
+static struct kobject poc_shim_kernel_kobj = { .name = "kernel" };
+struct kobject *kernel_kobj = &poc_shim_kernel_kobj;
+
+/*
+ * Clone the per-CPU template section once per CPU.  Runs before main()
+ * so that initcalls and the harness see populated areas.
+ */
+__attribute__((constructor))
+static void poc_shim_pcpu_init(void)
+{
+	size_t size = __stop_poc_percpu - __start_poc_percpu;
+	int cpu;
+
+	for (cpu = 0; cpu < NR_CPUS; cpu++) {
+		if (posix_memalign((void **)&poc_shim_pcpu_area[cpu], 64,
+				   size ? size : 64))
+			abort();
+		memcpy(poc_shim_pcpu_area[cpu], __start_poc_percpu, size);
+	}
+}
+
+unsigned int sysctl_sched_migration_cost = 500000U;
+u64 poc_shim_clock_ns;
+struct mm_struct init_mm;
+
+#include "trace/events/poc_selector.h"
+bool poc_shim_trace_on;
+__thread struct poc_shim_trace_select poc_shim_trace_sel;
+__thread struct poc_shim_trace_idle poc_shim_trace_idle;
+
+extern poc_shim_initcall_t __start_poc_initcall_early[] __attribute__((weak));
+extern poc_shim_initcall_t __stop_poc_initcall_early[] __attribute__((weak));
+extern poc_shim_initcall_t __start_poc_initcall_late[] __attribute__((weak));
+extern poc_shim_initcall_t __stop_poc_initcall_late[] __attribute__((weak));
+
+void poc_shim_run_initcalls(bool late)
+{
+	static bool done[2];
+	poc_shim_initcall_t *fn, *end;
+
+	if (done[late])
+		return;
+	done[late] = true;
+	fn = late ? __start_poc_initcall_late : __start_poc_initcall_early;
+	end = late ? __stop_poc_initcall_late : __stop_poc_initcall_early;
+	for (; fn && fn < end; fn++)
+		(*fn)();
+}
+
+void *kzalloc_node(size_t size, int flags, int node)
+{
+	void *p;
+
+	(void)flags;
+	(void)node;
+	if (posix_memalign(&p, 64, size))
+		return NULL;
+	memset(p, 0, size);
+	return p;
+}
+
+void *kcalloc(size_t n, size_t size, int flags)
+{
+	return kzalloc_node(n * size, flags, 0);
+}
+
+void kfree(const void *p)
+{
+	free((void *)p);
+}
+
+/* ---- sysctl: the harness drives handlers directly ---- */
+
+int proc_douintvec_minmax(const struct ctl_table *t, int write,
+			  void *buffer, size_t *lenp, loff_t *ppos)
+{
+	unsigned int *val = t->data;
+
+	(void)ppos;
+	if (write) {
+		unsigned int v = (unsigned int)strtoul(buffer, NULL, 0);
+
+		if (t->extra1 && v < *(unsigned int *)t->extra1)
+			return -EINVAL;
+		if (t->extra2 && v > *(unsigned int *)t->extra2)
+			return -EINVAL;
+		*val = v;
+	} else {
+		*lenp = snprintf(buffer, *lenp, "%u\n", *val);
+	}
+	return 0;
+}
+
+int proc_douintvec(const struct ctl_table *t, int write,
+		   void *buffer, size_t *lenp, loff_t *ppos)
+{
+	struct ctl_table tmp = *t;
+
+	tmp.extra1 = tmp.extra2 = NULL;
+	return proc_douintvec_minmax(&tmp, write, buffer, lenp, ppos);
+}
+
+static struct ctl_table *poc_shim_sysctl_table;
+static size_t poc_shim_sysctl_count;
+
+void poc_shim_register_sysctl(const char *path, struct ctl_table *t, size_t n)
+{
+	(void)path;
+	poc_shim_sysctl_table = t;
+	poc_shim_sysctl_count = n;
+}
+
+/*
+ * poc_shim_sysctl_write - write @val to kernel.<name>, as
+ * "sysctl -w kernel.<name>=<val>" would.  Returns the handler's result,
+ * or -ENOENT when no such knob is registered.
+ */
+int poc_shim_sysctl_write(const char *name, unsigned int val)
+{
+	char buf[32];
+	size_t len;
+	loff_t pos = 0;
+	size_t i;
+
+	for (i = 0; i < poc_shim_sysctl_count; i++) {
+		struct ctl_table *t = &poc_shim_sysctl_table[i];
+
+		if (strcmp(t->procname, name))
+			continue;
+		len = snprintf(buf, sizeof(buf), "%u", val);
+		return t->proc_handler(t, 1, buf, &len, &pos);
+	}
+	return -ENOENT;
+}
+
+/* ---- sysfs: groups are recorded so the harness can read them ---- */
+
+#define POC_SHIM_MAX_GROUPS 16
+static const struct attribute_group *poc_shim_groups[POC_SHIM_MAX_GROUPS];
+
+int sysfs_emit(char *buf, const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+
+	va_start(ap, fmt);
+	n = vsnprintf(buf, PAGE_SIZE, fmt, ap);
+	va_end(ap);
+	return n;
+}
+
+int sysfs_emit_at(char *buf, int at, const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+
+	if (at < 0 || at >= PAGE_SIZE)
+		return 0;
+	va_start(ap, fmt);
+	n = vsnprintf(buf + at, PAGE_SIZE - at, fmt, ap);
+	va_end(ap);
+	if (n > PAGE_SIZE - at - 1)
+		n = PAGE_SIZE - at - 1;
+	return n;
+}
+
+int scnprintf(char *buf, size_t size, const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+
+	if (!size)
+		return 0;
+	va_start(ap, fmt);
+	n = vsnprintf(buf, size, fmt, ap);
+	va_end(ap);
+	if (n > (int)size - 1)
+		n = size - 1;
+	return n;
+}
+
+int sysfs_create_group(struct kobject *k, const struct attribute_group *g)
+{
+	int i;
+
+	(void)k;
+	for (i = 0; i < POC_SHIM_MAX_GROUPS; i++) {
+		if (!poc_shim_groups[i]) {
+			poc_shim_groups[i] = g;
+			return 0;
+		}
+	}
+	return -ENOMEM;
+}
+
+void sysfs_remove_group(struct kobject *k, const struct attribute_group *g)
+{
+	int i;
+
+	(void)k;
+	for (i = 0; i < POC_SHIM_MAX_GROUPS; i++)
+		if (poc_shim_groups[i] == g)
+			poc_shim_groups[i] = NULL;
+}
+
+struct kobject *kobject_create_and_add(const char *name, struct kobject *parent)
+{
+	struct kobject *k = kzalloc(sizeof(*k), GFP_KERNEL);
+
+	(void)parent;
+	if (k)
+		k->name = name;
+	return k;
+}
+
+void kobject_put(struct kobject *k)
+{
+	kfree(k);
+}
+
+int kstrtouint(const char *s, unsigned int base, unsigned int *res)
+{
+	char *end;
+	unsigned long v = strtoul(s, &end, base);
+
+	if (end == s)
+		return -EINVAL;
+	*res = (unsigned int)v;
+	return 0;
+}
+
+int kstrtobool(const char *s, bool *res)
+{
+	if (!s)
+		return -EINVAL;
+	switch (s[0]) {
+	case 'y': case 'Y': case '1':
+		*res = true;
+		return 0;
+	case 'n': case 'N': case '0':
+		*res = false;
+		return 0;
+	}
+	return -EINVAL;
+}
+
+ssize_t memory_read_from_buffer(void *to, size_t count, loff_t *ppos,
+			       const void *from, size_t available)
+{
+	loff_t pos = *ppos;
+
+	if (pos < 0)
+		return -EINVAL;
+	if (pos >= available)
+		return 0;
+	if (count > available - pos)
+		count = available - pos;
+	memcpy(to, (const char *)from + pos, count);
+	*ppos = pos + count;
+	return count;
+}
+
+/*
+ * poc_shim_sysfs_read - read attribute "<group>/<name>" into @buf.
+ * Binary attributes are read from offset 0, up to PAGE_SIZE.  Returns the number of bytes produced, or -ENOENT.
+ */
+ssize_t poc_shim_sysfs_read(const char *group, const char *name, char *buf)
+{
+	int i;
+
+	for (i = 0; i < POC_SHIM_MAX_GROUPS; i++) {
+		const struct attribute_group *g = poc_shim_groups[i];
+		const struct bin_attribute *const *b;
+		struct attribute **a;
+
+		if (!g || !g->name || strcmp(g->name, group))
+			continue;
+		for (a = g->attrs; a && *a; a++) {
+			struct kobj_attribute *ka = (struct kobj_attribute *)*a;
+
+			if (!strcmp((*a)->name, name) && ka->show)
+				return ka->show(NULL, ka, buf);
+		}
+		for (b = g->bin_attrs; b && *b; b++)
+			if (!strcmp((*b)->attr.name, name) && (*b)->read)
+				return (*b)->read(NULL, NULL, *b, buf, 0,
+						  PAGE_SIZE);
+	}
+	return -ENOENT;
+}
@@ -0,0 +1,585 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * kernel_shim.h - Minimal kernel API surface for building
+ * kernel/sched/poc_selector.c as an ordinary userspace object.
+ *
+ * Only what the POC selector touches is provided.  Semantics follow
+ * the kernel closely enough for single-process replay:
+ *
+ *   - static keys are plain booleans (no text patching)
+ *   - per-CPU variables are cloned once per simulated CPU; "this CPU"
+ *     is the thread-local poc_shim_this_cpu
+ *   - atomic64_t maps onto GCC __atomic builtins
+ *   - RCU, cpus_read_lock(), workqueues and sysctl/sysfs registration
+ *     collapse to no-ops or direct calls
+ *
+ * Nothing here is meant to be fast except the pieces that sit on the
+ * selection path (atomics, bit ops), which compile to the same
+ * instructions the kernel would emit for the same -march.
+ */
+#ifndef _POC_KERNEL_SHIM_H
+#define _POC_KERNEL_SHIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#ifndef NR_CPUS
+#define NR_CPUS 512
+#endif
+
+/* ---- types ---- */
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int64_t  s64;
+typedef int      pid_t;
+
+typedef struct { int counter; } atomic_t;
+typedef struct { s64 counter; } atomic64_t;
+
+/* ---- compiler ---- */
+
+#undef __always_inline
+#define __always_inline		inline __attribute__((__always_inline__))
+#define __maybe_unused		__attribute__((__unused__))
+#define noinline		__attribute__((__noinline__))
+#define __init
+#define __read_mostly
+#define ____cacheline_aligned	__attribute__((__aligned__(64)))
+#define likely(x)		__builtin_expect(!!(x), 1)
+#define unlikely(x)		__builtin_expect(!!(x), 0)
+#define barrier()		__asm__ __volatile__("" ::: "memory")
+
+#define READ_ONCE(x)		(*(const volatile __typeof__(x) *)&(x))
+#define WRITE_ONCE(x, val)	(*(volatile __typeof__(x) *)&(x) = (val))
+
+#define smp_wmb()		__atomic_thread_fence(__ATOMIC_RELEASE)
+#define smp_rmb()		__atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define smp_mb()		__atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define xchg(ptr, v)		__atomic_exchange_n((ptr), (v), __ATOMIC_SEQ_CST)
+#define cmpxchg(ptr, o, n)	({ __typeof__(*(ptr)) __o = (o);		\
+	__atomic_compare_exchange_n((ptr), &__o, (n), false,		\
+				    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); __o; })
+#define smp_mb__before_atomic()	barrier()
+#define smp_mb__after_atomic()	barrier()
+#define prefetch(p)		__builtin_prefetch(p)
+#define prefetchw(p)		__builtin_prefetch(p, 1)
+
+#define DIV_ROUND_UP(n, d)	(((n) + (d) - 1) / (d))
+#define ARRAY_SIZE(a)		(sizeof(a) / sizeof((a)[0]))
+#define BITS_PER_LONG		64
+#define BITS_TO_LONGS(n)	(((n) + BITS_PER_LONG - 1) / BITS_PER_LONG)
+#define min(a, b)		((a) < (b) ? (a) : (b))
+#define max(a, b)		((a) > (b) ? (a) : (b))
+#define min3(a, b, c)		min(min(a, b), c)
+#define U8_MAX			((u8)~0U)
+
+/* ---- bit ops ---- */
+
+static inline unsigned int hweight64(u64 w) { return __builtin_popcountll(w); }
+static inline unsigned int hweight32(u32 w) { return __builtin_popcount(w); }
+static inline unsigned long __ffs(unsigned long w) { return __builtin_ctzl(w); }
+static inline unsigned long __fls(unsigned long w) { return 63 - __builtin_clzl(w); }
+static inline int fls64(u64 w) { return w ? 64 - __builtin_clzll(w) : 0; }
+static inline u32 ror32(u32 w, unsigned int s) { return (w >> (s & 31)) | (w << ((-s) & 31)); }
+static inline u64 ror64(u64 w, unsigned int s) { return (w >> (s & 63)) | (w << ((-s) & 63)); }
+static inline bool is_power_of_2(unsigned long n) { return n && !(n & (n - 1)); }
+static inline int ilog2(u64 n) { return 63 - __builtin_clzll(n); }
+
+/* ---- cycle counter ---- */
+
+typedef u64 cycles_t;
+static inline cycles_t get_cycles(void)
+{
+#if defined(__x86_64__)
+	return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+	u64 v;
+
+	__asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(v));
+	return v;
+#else
+	return 0;
+#endif
+}
+
+/*
+ * local_clock(): a virtual nanosecond clock the harness advances, so
+ * time-window heuristics (sched_poc_burst) replay deterministically.
+ */
+#define NSEC_PER_USEC		1000ULL
+extern u64 poc_shim_clock_ns;
+static inline u64 local_clock(void) { return poc_shim_clock_ns; }
+
+/* ---- atomics ---- */
+
+#define ATOMIC64_INIT(i)	{ (i) }
+static inline s64 atomic64_read(const atomic64_t *v)
+{ return __atomic_load_n(&v->counter, __ATOMIC_RELAXED); }
+static inline void atomic64_set(atomic64_t *v, s64 i)
+{ __atomic_store_n(&v->counter, i, __ATOMIC_RELAXED); }
+static inline void atomic64_or(s64 i, atomic64_t *v)
+{ __atomic_fetch_or(&v->counter, i, __ATOMIC_SEQ_CST); }
+static inline void atomic64_and(s64 i, atomic64_t *v)
+{ __atomic_fetch_and(&v->counter, i, __ATOMIC_SEQ_CST); }
+static inline void atomic64_andnot(s64 i, atomic64_t *v)
+{ __atomic_fetch_and(&v->counter, ~i, __ATOMIC_SEQ_CST); }
+static inline s64 atomic64_fetch_andnot(s64 i, atomic64_t *v)
+{ return __atomic_fetch_and(&v->counter, ~i, __ATOMIC_SEQ_CST); }
+static inline s64 atomic64_fetch_or(s64 i, atomic64_t *v)
+{ return __atomic_fetch_or(&v->counter, i, __ATOMIC_SEQ_CST); }
+static inline s64 atomic64_xchg(atomic64_t *v, s64 i)
+{ return __atomic_exchange_n(&v->counter, i, __ATOMIC_SEQ_CST); }
+static inline bool atomic64_try_cmpxchg(atomic64_t *v, s64 *old, s64 new)
+{ return __atomic_compare_exchange_n(&v->counter, old, new, false,
+				     __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); }
+static inline void atomic64_add(s64 i, atomic64_t *v)
+{ __atomic_fetch_add(&v->counter, i, __ATOMIC_SEQ_CST); }
+static inline void atomic64_inc(atomic64_t *v)
+{ atomic64_add(1, v); }
+static inline int atomic_read(const atomic_t *v)
+{ return __atomic_load_n(&v->counter, __ATOMIC_RELAXED); }
+static inline void atomic_set(atomic_t *v, int i)
+{ __atomic_store_n(&v->counter, i, __ATOMIC_RELAXED); }
+
+/* ---- static keys (plain booleans) ---- */
+
+struct static_key	{ bool enabled; };
+struct static_key_true  { struct static_key key; };
+struct static_key_false { struct static_key key; };
+#define DEFINE_STATIC_KEY_TRUE(name)	struct static_key_true name = { { true } }
+#define DEFINE_STATIC_KEY_FALSE(name)	struct static_key_false name = { { false } }
+#define DECLARE_STATIC_KEY_TRUE(name)	extern struct static_key_true name
+#define DECLARE_STATIC_KEY_FALSE(name)	extern struct static_key_false name
+#define static_branch_likely(k)		likely((k)->key.enabled)
+#define static_branch_unlikely(k)	unlikely((k)->key.enabled)
+#define static_branch_enable(k)		((k)->key.enabled = true)
+#define static_branch_disable(k)	((k)->key.enabled = false)
+#define static_branch_enable_cpuslocked(k)	static_branch_enable(k)
+#define static_branch_disable_cpuslocked(k)	static_branch_disable(k)
+/* Any of the three key types: .key is the first member */
+#define static_key_enabled(k)		(((struct static_key *)(k))->enabled)
+#define static_key_enable_cpuslocked(k)	(((struct static_key *)(k))->enabled = true)
+#define static_key_disable_cpuslocked(k) (((struct static_key *)(k))->enabled = false)
+
+/* ---- per-CPU ---- */
+
+/*
+ * Per-CPU variables live in a dedicated "poc_percpu" section, exactly
+ * like the kernel's .data..percpu template.  kernel_shim.c clones the
+ * section once per simulated CPU; accessors translate the template
+ * address into the clone for the requested CPU.  This keeps kernel
+ * idioms such as __this_cpu_inc(poc_debug_cnt[lv]) working unchanged.
+ */
+/*
+ * local-exec: always linked into the executable, and GCC may emit an
+ * initial-exec "lea" that ld cannot relax.
+ */
+extern __thread int poc_shim_this_cpu __attribute__((tls_model("local-exec")));
+extern char __start_poc_percpu[], __stop_poc_percpu[];
+extern char *poc_shim_pcpu_area[NR_CPUS];
+
+#define DEFINE_PER_CPU(type, name) \
+	__typeof__(type) name __attribute__((__section__("poc_percpu"), __used__))
+#define DEFINE_PER_CPU_ALIGNED(type, name) \
+	DEFINE_PER_CPU(type, name) ____cacheline_aligned
+#define DECLARE_PER_CPU(type, name)	extern __typeof__(type) name
+
+#define POC_SHIM_PCPU_ADDR(ptr, cpu) \
+	((__typeof__(&(ptr)[0]))(poc_shim_pcpu_area[cpu] + \
+		((char *)(ptr) - __start_poc_percpu)))
+
+#define per_cpu_ptr(ptr, cpu)		POC_SHIM_PCPU_ADDR(ptr, cpu)
+#define per_cpu(var, cpu)		(*POC_SHIM_PCPU_ADDR(&(var), cpu))
+#define this_cpu_ptr(ptr)		per_cpu_ptr(ptr, poc_shim_this_cpu)
+#define __this_cpu_read(var)		per_cpu(var, poc_shim_this_cpu)
+#define __this_cpu_write(var, v)	(per_cpu(var, poc_shim_this_cpu) = (v))
+#define __this_cpu_inc(var)		(per_cpu(var, poc_shim_this_cpu)++)
+#define __this_cpu_add(var, n)		(per_cpu(var, poc_shim_this_cpu) += (n))
+#define __this_cpu_inc_return(var)	(++per_cpu(var, poc_shim_this_cpu))
+#define this_cpu_read(var)		__this_cpu_read(var)
+#define this_cpu_write(var, v)		__this_cpu_write(var, v)
+#define this_cpu_inc(var)		__this_cpu_inc(var)
+#define this_cpu_add(var, n)		__this_cpu_add(var, n)
+
+#define smp_processor_id()		poc_shim_this_cpu
+#define raw_smp_processor_id()		poc_shim_this_cpu
+
+/* ---- cpumask ---- */
+
+struct cpumask { unsigned long bits[BITS_TO_LONGS(NR_CPUS)]; };
+typedef struct cpumask cpumask_var_t[1];
+#define zalloc_cpumask_var(m, f)	(memset(*(m), 0, sizeof(**(m))), true)
+#define free_cpumask_var(m)		do { } while (0)
+
+extern unsigned int nr_cpu_ids;
+extern struct cpumask poc_shim_online_mask;
+
+#define nr_cpumask_bits			nr_cpu_ids
+#define cpumask_bits(m)			((m)->bits)
+#define cpu_online_mask			(&poc_shim_online_mask)
+#define cpu_possible_mask		(&poc_shim_online_mask)
+
+static inline bool cpumask_test_cpu(int cpu, const struct cpumask *m)
+{ return (m->bits[cpu / 64] >> (cpu % 64)) & 1; }
+static inline void cpumask_set_cpu(int cpu, struct cpumask *m)
+{ m->bits[cpu / 64] |= 1UL << (cpu % 64); }
+static inline void cpumask_clear_cpu(int cpu, struct cpumask *m)
+{ m->bits[cpu / 64] &= ~(1UL << (cpu % 64)); }
+static inline void cpumask_clear(struct cpumask *m)
+{ memset(m, 0, sizeof(*m)); }
+static inline void cpumask_copy(struct cpumask *d, const struct cpumask *s)
+{ *d = *s; }
+static inline unsigned int cpumask_next(int n, const struct cpumask *m)
+{
+	for (n++; n < (int)nr_cpu_ids; n++)
+		if (cpumask_test_cpu(n, m))
+			return n;
+	return nr_cpu_ids;
+}
+static inline unsigned int cpumask_first(const struct cpumask *m)
+{ return cpumask_next(-1, m); }
+static inline unsigned int cpumask_last(const struct cpumask *m)
+{
+	int n;
+
+	for (n = nr_cpu_ids - 1; n >= 0; n--)
+		if (cpumask_test_cpu(n, m))
+			return n;
+	return nr_cpu_ids;
+}
+static inline unsigned int cpumask_weight(const struct cpumask *m)
+{
+	unsigned int i, w = 0;
+
+	for (i = 0; i < BITS_TO_LONGS(NR_CPUS); i++)
+		w += __builtin_popcountl(m->bits[i]);
+	return w;
+}
+static inline bool cpumask_full(const struct cpumask *m)
+{ return cpumask_weight(m) >= nr_cpu_ids; }
+#define num_possible_cpus()		nr_cpu_ids
+#define num_online_cpus()		cpumask_weight(cpu_online_mask)
+static inline bool cpumask_subset(const struct cpumask *a, const struct cpumask *b)
+{
+	unsigned int i;
+
+	for (i = 0; i < BITS_TO_LONGS(NR_CPUS); i++)
+		if (a->bits[i] & ~b->bits[i])
+			return false;
+	return true;
+}
+static inline bool cpumask_equal(const struct cpumask *a, const struct cpumask *b)
+{ return !memcmp(a, b, sizeof(*a)); }
+
+#define for_each_cpu(cpu, mask) \
+	for ((cpu) = cpumask_first(mask); (cpu) < (int)nr_cpu_ids; \
+	     (cpu) = cpumask_next((cpu), (mask)))
+#define for_each_online_cpu(cpu)	for_each_cpu(cpu, cpu_online_mask)
+#define for_each_possible_cpu(cpu)	for_each_cpu(cpu, cpu_possible_mask)
+
+/* ---- topology (filled in by the harness) ---- */
+
+extern struct cpumask poc_shim_smt_mask[NR_CPUS];
+extern struct cpumask poc_shim_cluster_mask[NR_CPUS];
+extern int poc_shim_cpu_node[NR_CPUS];
+extern bool poc_shim_smt_active;
+extern bool poc_shim_asym_active;
+
+#define cpu_smt_mask(cpu)		(&poc_shim_smt_mask[cpu])
+#define cpu_clustergroup_mask(cpu)	(&poc_shim_cluster_mask[cpu])
+#define topology_sibling_cpumask(cpu)	(&poc_shim_smt_mask[cpu])
+#define cpu_to_node(cpu)		(poc_shim_cpu_node[cpu])
+#ifndef MAX_NUMNODES
+#define MAX_NUMNODES			8
+#endif
+#define NUMA_NO_NODE			(-1)
+#define for_each_node(node)		for ((node) = 0; (node) < MAX_NUMNODES; (node)++)
+#define sched_smt_active()		(poc_shim_smt_active)
+#define sched_asym_cpucap_active()	(poc_shim_asym_active)
+
+/* ---- scheduler core ---- */
+
+struct cfs_rq {
+	int			idle;		/* cpu.idle of the owning group */
+};
+
+struct sched_entity {
+	u64			exec_start;
+	u64			sum_exec_runtime;
+	struct cfs_rq		*cfs_rq;	/* NULL: root group */
+};
+
+struct mm_struct {
+	int			id;
+};
+extern struct mm_struct init_mm;
+
+struct task_struct {
+	int			pid;
+	unsigned int		policy;		/* SCHED_NORMAL / BATCH / IDLE */
+	struct mm_struct	*mm;
+	struct mm_struct	*active_mm;
+	const struct cpumask	*cpus_ptr;
+	struct cpumask		cpus_mask;
+	int			nr_cpus_allowed;
+	struct sched_entity	se;
+	unsigned long		util_est;	/* task_util_est() */
+	unsigned long		uclamp_min;	/* 0 = none */
+	unsigned long		uclamp_max;	/* 0 = none (1024) */
+#include "poc_fields_task_struct.h"
+};
+
+extern unsigned int sysctl_sched_migration_cost;
+
+#define SCHED_NORMAL		0
+#define SCHED_BATCH		3
+#define SCHED_IDLE		5
+
+static inline int task_has_idle_policy(struct task_struct *p)
+{
+	return p->policy == SCHED_IDLE;
+}
+
+#define cfs_rq_of(se)		((se)->cfs_rq)
+
+static inline int cfs_rq_is_idle(struct cfs_rq *cfs_rq)
+{
+	return cfs_rq && cfs_rq->idle;
+}
+
+/* current: the task running on poc_shim_this_cpu (rq->curr) */
+#define current				(poc_shim_rqs[poc_shim_this_cpu].curr)
+
+struct rq {
+	unsigned int		nr_running;
+	u64			nr_switches;
+	u64			clock_task;
+	struct task_struct	*curr;
+	struct task_struct	*idle;
+#include "poc_fields_rq.h"
+};
+
+struct sched_domain_shared {
+	atomic_t	ref;
+	atomic_t	nr_busy_cpus;
+	int		has_idle_cores;
+	int		nr_idle_scan;
+#include "poc_fields_sched_domain_shared.h"
+};
+
+struct sched_domain {
+	struct sched_domain_shared *shared;
+	unsigned int span_weight;
+	struct cpumask span;
+};
+
+#define sched_domain_span(sd)		(&(sd)->span)
+
+extern struct rq poc_shim_rqs[NR_CPUS];
+#define cpu_rq(cpu)			(&poc_shim_rqs[cpu])
+#define this_rq()			cpu_rq(poc_shim_this_cpu)
+
+DECLARE_PER_CPU(struct sched_domain_shared *, sd_llc_shared);
+DECLARE_PER_CPU(int, sd_llc_id);
+DECLARE_PER_CPU(int, sd_llc_size);
+
+/* nohz_full / isolcpus: the harness sets poc_shim_isolated_mask */
+enum hk_type { HK_TYPE_DOMAIN, HK_TYPE_KERNEL_NOISE };
+extern struct cpumask poc_shim_isolated_mask;
+static inline bool housekeeping_cpu(int cpu, enum hk_type type)
+{ return (void)type, !cpumask_test_cpu(cpu, &poc_shim_isolated_mask); }
+#define sched_domains_mutex_lock()	do { } while (0)
+#define sched_domains_mutex_unlock()	do { } while (0)
+
+static inline int idle_cpu(int cpu)
+{ return cpu_rq(cpu)->curr == cpu_rq(cpu)->idle && !cpu_rq(cpu)->nr_running; }
+
+/*
+ * Capacity model: poc_shim_cpu_capacity[] (0 = 1024).  No pressure,
+ * so capacity_of() == get_actual_cpu_capacity() == arch capacity.
+ * util_fits_cpu() follows fair.c's return convention: 1 fits, 0 does
+ * not, -1 fits util but not uclamp_min.
+ */
+#define SCHED_CAPACITY_SCALE		1024UL
+extern unsigned long poc_shim_cpu_capacity[NR_CPUS];
+static inline unsigned long arch_scale_cpu_capacity(int cpu)
+{ return poc_shim_cpu_capacity[cpu] ? poc_shim_cpu_capacity[cpu] : SCHED_CAPACITY_SCALE; }
+#define capacity_of(cpu)		arch_scale_cpu_capacity(cpu)
+#define get_actual_cpu_capacity(cpu)	arch_scale_cpu_capacity(cpu)
+#define fits_capacity(cap, max)		((cap) * 1280 < (max) * 1024)
+
+enum uclamp_id { UCLAMP_MIN, UCLAMP_MAX };
+#define task_util_est(p)		((p)->util_est)
+static inline unsigned long uclamp_eff_value(struct task_struct *p,
+					     enum uclamp_id id)
+{
+	if (id == UCLAMP_MIN)
+		return p->uclamp_min;
+	return p->uclamp_max ? p->uclamp_max : SCHED_CAPACITY_SCALE;
+}
+static inline int util_fits_cpu(unsigned long util, unsigned long uclamp_min,
+				unsigned long uclamp_max, int cpu)
+{
+	unsigned long cap = capacity_of(cpu);
+
+	if (!fits_capacity(util, cap) && uclamp_max >= cap)
+		return 0;
+	if (uclamp_min > cap)
+		return -1;
+	return 1;
+}
+
+#define cpu_of(rq)			((int)((rq) - poc_shim_rqs))
+/* Idle tasks are pid 0; a NULL curr also counts as idle */
+#define is_idle_task(p)			(!(p) || !(p)->pid)
+
+DECLARE_STATIC_KEY_FALSE(sched_cluster_active);
+
+enum { SIS_UTIL = 0 };
+extern bool poc_shim_sched_feat[1];
+#define sched_feat(x)			(poc_shim_sched_feat[x])
+
+/* ---- RCU / locking ---- */
+
+struct rcu_head { void *next; };
+#define rcu_dereference(p)		READ_ONCE(p)
+#define rcu_read_lock()			do { } while (0)
+#define rcu_read_unlock()		do { } while (0)
+#define guard(name)			poc_shim_guard_##name
+#define scoped_guard(name, ...)		if (1)
+static inline void poc_shim_guard_rcu(void) { }
+static inline void poc_shim_guard_preempt(void) { }
+static inline void cpus_read_lock(void) { }
+static inline void cpus_read_unlock(void) { }
+#define lockdep_assert_irqs_disabled()	do { } while (0)
+#define local_irq_save(flags)		((void)(flags))
+#define local_irq_restore(flags)	((void)(flags))
+
+/* ---- workqueue ---- */
+
+struct work_struct { void (*func)(struct work_struct *); };
+#define DECLARE_WORK(n, f)		struct work_struct n = { .func = (f) }
+#define INIT_WORK(w, f)			((w)->func = (f))
+static inline bool schedule_work(struct work_struct *w)
+{ w->func(w); return true; }
+
+/* ---- memory ---- */
+
+#define GFP_KERNEL 0
+#define __GFP_THISNODE 0
+#define __GFP_NOWARN 0
+void *kzalloc_node(size_t size, int flags, int node);
+void *kcalloc(size_t n, size_t size, int flags);
+void kfree(const void *p);
+#define kzalloc(s, f)			kzalloc_node((s), (f), 0)
+#define kfree_rcu(p, field)		kfree(p)
+#define kvcalloc(n, s, f)		kcalloc((n), (s), (f))
+#define kvzalloc(s, f)			kzalloc((s), (f))
+#define kvfree(p)			kfree(p)
+
+/* One allocation pool: every block "lands" on node 0 */
+struct page;
+#define virt_to_page(addr)		((struct page *)(addr))
+#define page_to_nid(page)		((void)(page), 0)
+
+/* ---- printk ---- */
+
+#define KERN_INFO			""
+#define KERN_WARNING			""
+#define printk(fmt, ...)		fprintf(stderr, fmt, ##__VA_ARGS__)
+#define pr_info(fmt, ...)		fprintf(stderr, fmt, ##__VA_ARGS__)
+#define pr_warn(fmt, ...)		fprintf(stderr, fmt, ##__VA_ARGS__)
+#define pr_info_once(fmt, ...)		pr_info(fmt, ##__VA_ARGS__)
+#define pr_warn_once(fmt, ...)		pr_warn(fmt, ##__VA_ARGS__)
+#define WARN_ON_ONCE(c)			({ bool __c = !!(c); __c; })
+
+/* ---- initcalls ---- */
+
+typedef int (*poc_shim_initcall_t)(void);
+#define poc_shim_initcall(fn, lvl) \
+	static poc_shim_initcall_t poc_shim_##lvl##_##fn \
+	__attribute__((used, section("poc_initcall_" #lvl))) = fn
+#define early_initcall(fn)	poc_shim_initcall(fn, early)
+#define late_initcall(fn)	poc_shim_initcall(fn, late)
+/* Run every initcall of one level ("early" before topology, "late" after) */
+void poc_shim_run_initcalls(bool late);
+
+/* ---- sysctl ---- */
+
+struct ctl_table {
+	const char	*procname;
+	void		*data;
+	int		maxlen;
+	unsigned short	mode;
+	int		(*proc_handler)(const struct ctl_table *, int,
+					void *, size_t *, loff_t *);
+	void		*extra1;
+	void		*extra2;
+};
+extern unsigned int poc_shim_zero, poc_shim_one;
+#define SYSCTL_ZERO		((void *)&poc_shim_zero)
+#define SYSCTL_ONE		((void *)&poc_shim_one)
+int proc_douintvec_minmax(const struct ctl_table *t, int write,
+			  void *buffer, size_t *lenp, loff_t *ppos);
+int proc_douintvec(const struct ctl_table *t, int write,
+		   void *buffer, size_t *lenp, loff_t *ppos);
+#define register_sysctl_init(path, table) \
+	poc_shim_register_sysctl((path), (table), ARRAY_SIZE(table))
+void poc_shim_register_sysctl(const char *path, struct ctl_table *t, size_t n);
+
+/* ---- sysfs / kobject ---- */
+
+struct kobject { const char *name; };
+struct attribute { const char *name; unsigned short mode; };
+struct kobj_attribute {
+	struct attribute attr;
+	ssize_t (*show)(struct kobject *, struct kobj_attribute *, char *);
+	ssize_t (*store)(struct kobject *, struct kobj_attribute *,
+			 const char *, size_t);
+};
+struct file;
+struct bin_attribute {
+	struct attribute attr;
+	ssize_t (*read)(struct file *, struct kobject *,
+			const struct bin_attribute *, char *, loff_t, size_t);
+};
+struct attribute_group {
+	const char		*name;
+	struct attribute	**attrs;
+	const struct bin_attribute *const *bin_attrs;
+};
+#define __ATTR_RO(n)	{ .attr = { .name = #n, .mode = 0444 }, .show = n##_show }
+#define __ATTR_WO(n)	{ .attr = { .name = #n, .mode = 0200 }, .store = n##_store }
+#define __ATTR_RW(n)	{ .attr = { .name = #n, .mode = 0644 }, \
+			  .show = n##_show, .store = n##_store }
+#define PAGE_SIZE	4096
+extern struct kobject *kernel_kobj;
+int sysfs_emit(char *buf, const char *fmt, ...)
+	__attribute__((format(printf, 2, 3)));
+int sysfs_emit_at(char *buf, int at, const char *fmt, ...)
+	__attribute__((format(printf, 3, 4)));
+int scnprintf(char *buf, size_t size, const char *fmt, ...)
+	__attribute__((format(printf, 3, 4)));
+int sysfs_create_group(struct kobject *k, const struct attribute_group *g);
+void sysfs_remove_group(struct kobject *k, const struct attribute_group *g);
+struct kobject *kobject_create_and_add(const char *name, struct kobject *parent);
+void kobject_put(struct kobject *k);
+ssize_t memory_read_from_buffer(void *to, size_t count, loff_t *ppos,
+			       const void *from, size_t available);
+int kstrtouint(const char *s, unsigned int base, unsigned int *res);
+int kstrtobool(const char *s, bool *res);
+
+/* ---- arch ---- */
+
+#define X86_FEATURE_POPCNT	0
+#define boot_cpu_has(f)		(__builtin_cpu_supports("popcnt"))
+
+#endif /* _POC_KERNEL_SHIM_H */
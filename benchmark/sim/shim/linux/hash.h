@@ -0,0 +1,17 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Subset of include/linux/hash.h used by poc_selector.c */
+#ifndef _POC_SHIM_LINUX_HASH_H
+#define _POC_SHIM_LINUX_HASH_H
+
+#include <stdint.h>
+
+#define GOLDEN_RATIO_64 0x61C8864680B583EBull
+
+static inline uint32_t hash_64(uint64_t val, unsigned int bits)
+{
+	return (uint32_t)((val * GOLDEN_RATIO_64) >> (64 - bits));
+}
+
+#define hash_ptr(ptr, bits)	hash_64((uint64_t)(uintptr_t)(ptr), bits)
+
+#endif
@@ -0,0 +1,11 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Subset of include/linux/static_call.h used by poc_selector.c */
+#ifndef _POC_SHIM_LINUX_STATIC_CALL_H
+#define _POC_SHIM_LINUX_STATIC_CALL_H
+
+/* A static call is a function pointer here; no text is patched */
+#define DEFINE_STATIC_CALL(name, func)	__typeof__(&(func)) poc_sc_##name = (func)
+#define static_call(name)		(poc_sc_##name)
+#define static_call_update(name, func)	(poc_sc_##name = (func))
+
+#endif
@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Shim for include/trace/events/poc_selector.h: each event is a plain
+ * function gated by a flag, recording its last payload so the harness
+ * can inspect it.  There is no ring buffer.
+ */
+#ifndef _SHIM_TRACE_POC_SELECTOR_H
+#define _SHIM_TRACE_POC_SELECTOR_H
+
+struct poc_shim_trace_select {
+	int target, prev, recent, cpu, level, base;
+	u64 idle_cpus, idle_cores;
+	unsigned long hits;
+};
+
+struct poc_shim_trace_idle {
+	int cpu, state, committed;
+	unsigned long hits;
+};
+
+extern bool poc_shim_trace_on;
+extern __thread struct poc_shim_trace_select poc_shim_trace_sel;
+extern __thread struct poc_shim_trace_idle poc_shim_trace_idle;
+
+static inline bool trace_sched_poc_select_enabled(void)
+{
+	return poc_shim_trace_on;
+}
+
+static inline bool trace_sched_poc_idle_state_enabled(void)
+{
+	return poc_shim_trace_on;
+}
+
+static inline void trace_sched_poc_select(int target, int prev, int recent,
+					  int cpu, int level, int base,
+					  u64 idle_cpus, u64 idle_cores)
+{
+	struct poc_shim_trace_select *t = &poc_shim_trace_sel;
+
+	if (!poc_shim_trace_on)
+		return;
+	t->target = target;
+	t->prev = prev;
+	t->recent = recent;
+	t->cpu = cpu;
+	t->level = level;
+	t->base = base;
+	t->idle_cpus = idle_cpus;
+	t->idle_cores = idle_cores;
+	t->hits++;
+}
+
+static inline void trace_sched_poc_idle_state(int cpu, int state,
+					      int committed)
+{
+	struct poc_shim_trace_idle *t = &poc_shim_trace_idle;
+
+	if (!poc_shim_trace_on)
+		return;
+	t->cpu = cpu;
+	t->state = state;
+	t->committed = committed;
+	t->hits++;
+}
+
+#endif /* _SHIM_TRACE_POC_SELECTOR_H */
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * topo.c - Build a synthetic CPU topology for the shim and run the
+ * kernel's poc_sd_shared_init() over every LLC, the way
+ * build_sched_domains() does.
+ */
+#include "topo.h"
+
+extern void poc_sd_shared_init(struct sched_domain *sd, int sd_id);
+
+/* CPU id of sibling @k of core @core inside an LLC starting at @first */
+static int topo_cpu(const struct poc_topo *t, int first, int core, int k)
+{
+	if (t->smt_stride == POC_TOPO_MIXED) {
+		int half = t->llc_cpus / t->smt / 2;
+
+		if (core < half)
+			return first + core * t->smt + k;
+		return first + half * t->smt + (core - half) + k * half;
+	}
+	if (t->smt_stride)
+		return first + core + k * t->smt_stride;
+	return first + core * t->smt + k;
+}
+
+/* Every rq's idle task; on do_idle() entry it borrows init_mm */
+static struct task_struct poc_topo_idle = { .pid = 0, .active_mm = &init_mm };
+
+int poc_topo_build(const struct poc_topo *t, struct poc_topo_state *st)
+{
+	int cores = t->llc_cpus / t->smt;
+	int llc, core, k, cpu;
+
+	if (t->nr_llc > POC_TOPO_MAX_LLC ||
+	    t->base + t->nr_llc * t->llc_cpus > NR_CPUS)
+		return -EINVAL;
+	if (t->smt_stride > 0 &&
+	    t->smt_stride * (t->smt - 1) + cores > t->llc_cpus)
+		return -EINVAL;
+	if (t->smt_stride == POC_TOPO_MIXED && (t->smt != 2 || cores % 2))
+		return -EINVAL;
+
+	poc_shim_run_initcalls(false);
+	memset(st, 0, sizeof(*st));
+	st->nr_llc = t->nr_llc;
+	st->nr_cpus = t->base + t->nr_llc * t->llc_cpus;
+	nr_cpu_ids = st->nr_cpus;
+	poc_shim_smt_active = t->smt > 1;
+
+	cpumask_clear(&poc_shim_online_mask);
+	for (cpu = t->base; cpu < st->nr_cpus; cpu++)
+		cpumask_set_cpu(cpu, &poc_shim_online_mask);
+
+	for (llc = 0; llc < t->nr_llc; llc++) {
+		int first = t->base + llc * t->llc_cpus;
+		struct sched_domain *sd = &st->sd[llc];
+
+		st->llc_first[llc] = first;
+		cpumask_clear(&sd->span);
+		for (cpu = first; cpu < first + t->llc_cpus; cpu++)
+			cpumask_set_cpu(cpu, &sd->span);
+		sd->span_weight = t->llc_cpus;
+
+		for (core = 0; core < cores; core++) {
+			struct cpumask smt;
+
+			cpumask_clear(&smt);
+			for (k = 0; k < t->smt; k++)
+				cpumask_set_cpu(topo_cpu(t, first, core, k), &smt);
+			for (k = 0; k < t->smt; k++)
+				poc_shim_smt_mask[topo_cpu(t, first, core, k)] = smt;
+		}
+
+		for (cpu = first; cpu < first + t->llc_cpus; cpu++) {
+			struct cpumask *cls = &poc_shim_cluster_mask[cpu];
+			int rel = cpu - first;
+
+			cpumask_clear(cls);
+			if (t->cluster) {
+				int c0 = first + rel / t->cluster * t->cluster;
+
+				for (k = 0; k < t->cluster; k++)
+					cpumask_set_cpu(c0 + k, cls);
+			} else {
+				cpumask_set_cpu(cpu, cls);
+			}
+			poc_shim_cpu_node[cpu] = t->llc_per_node ?
+				llc / t->llc_per_node : 0;
+		}
+
+		st->sds[llc] = kzalloc(sizeof(struct sched_domain_shared), GFP_KERNEL);
+		if (!st->sds[llc])
+			return -ENOMEM;
+		sd->shared = st->sds[llc];
+		for (cpu = first; cpu < first + t->llc_cpus; cpu++) {
+			per_cpu(sd_llc_shared, cpu) = st->sds[llc];
+			per_cpu(sd_llc_id, cpu) = first;
+			per_cpu(sd_llc_size, cpu) = t->llc_cpus;
+			cpu_rq(cpu)->nr_running = 0;
+			cpu_rq(cpu)->idle = &poc_topo_idle;
+			cpu_rq(cpu)->curr = cpu_rq(cpu)->idle;
+		}
+		poc_sd_shared_init(sd, first);
+	}
+
+	if (t->cluster)
+		static_branch_enable(&sched_cluster_active);
+	else
+		static_branch_disable(&sched_cluster_active);
+	poc_shim_run_initcalls(true);
+	return 0;
+}
+
+int poc_topo_llc_of(const struct poc_topo_state *st, int cpu)
+{
+	int llc;
+
+	for (llc = st->nr_llc - 1; llc >= 0; llc--)
+		if (cpu >= st->llc_first[llc])
+			return llc;
+	return -1;
+}
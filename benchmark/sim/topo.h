@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _POC_TOPO_H
+#define _POC_TOPO_H
+
+#include "kernel_shim.h"
+
+/*
+ * Synthetic topology description.
+ *
+ *   nr_llc       number of LLC domains
+ *   llc_cpus     logical CPUs per LLC
+ *   smt          SMT ways (1 = no SMT)
+ *   smt_stride   0 = siblings consecutive (0,1 / 2,3 ...);
+ *                POC_TOPO_MIXED = first half of the LLC consecutive,
+ *                second half stride-N (no uniform sibling distance,
+ *                forces SMT tier 3);
+ *                otherwise sibling k of core c sits at c + k * stride
+ *                (stride-N layout, e.g. Intel Xeon)
+ *   cluster      CPUs per L2 cluster (0 = no cluster level)
+ *   base         CPU id of the first CPU in LLC 0 (non-zero makes the
+ *                LLC bases unaligned, as on Threadripper)
+ *   llc_per_node LLCs per NUMA node (0 = all LLCs on node 0)
+ */
+struct poc_topo {
+	const char *name;
+	int nr_llc;
+	int llc_cpus;
+	int smt;
+	int smt_stride;
+	int cluster;
+	int base;
+	int llc_per_node;
+};
+
+#define POC_TOPO_MIXED	(-1)
+#define POC_TOPO_MAX_LLC 16
+
+struct poc_topo_state {
+	int nr_cpus;
+	int nr_llc;
+	int llc_first[POC_TOPO_MAX_LLC];
+	struct sched_domain sd[POC_TOPO_MAX_LLC];
+	struct sched_domain_shared *sds[POC_TOPO_MAX_LLC];
+};
+
+int poc_topo_build(const struct poc_topo *t, struct poc_topo_state *st);
+int poc_topo_llc_of(const struct poc_topo_state *st, int cpu);
+
+#endif